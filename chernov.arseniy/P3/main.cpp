@@ -1,77 +1,166 @@
 #include <iostream>
+#include <algorithm>
+#include <vector>
 #include <fstream>
 #include <limits>
+#include <new>
+#include <stdexcept>
 #include <cctype>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <matrix_writer.hpp>
+#include <diagonals.hpp>
+#include <row_window.hpp>
+#include <multi_query.hpp>
+#include <tiled_file.hpp>
 
 namespace chernov {
   std::istream & matrixInput(std::istream & input, int * mtx, size_t rows, size_t cols);
+  using AntiSums = common::MultiQuery< common::DiagonalStats >;
+
+  class WaveRowWriter {
+  public:
+    WaveRowWriter(common::BufferedWriter & writer, size_t rows, size_t cols);
+    void operator()(const int * above, const int * row, const int * below, size_t cols);
+
+  private:
+    common::BufferedWriter & writer_;
+    size_t rows_;
+    size_t row_;
+    std::vector< int > values_;
+  };
+
+  void addRun(int * cells, size_t count, int value);
+  void addWaveRow(int * row, size_t rows, size_t cols, size_t y);
   void fllIncWav(int * mtx, size_t rows, size_t cols);
-  int minSumMdg(const int * mtx, size_t rows, size_t cols);
-  int getSumAntiDiagonal(const int * mtx, size_t x, size_t y, size_t rows, size_t cols);
+  long long minAntiSum(const common::DiagonalStats & diagonals);
+  long long minSumMdg(const int * mtx, size_t rows, size_t cols);
+  template< class Scan >
+  int streamResults(std::ostream & output, size_t rows, size_t cols, Scan scan);
   int processMatrix(std::istream & input, std::ostream & output, int * matrix, size_t rows, size_t cols);
+  void writeResults(std::ostream & output, int * matrix, size_t rows, size_t cols);
+  int run(int argc, char ** argv);
 }
 
 std::istream & chernov::matrixInput(std::istream & input, int * mtx, size_t rows, size_t cols)
 {
-  for (size_t i = 0; i < rows * cols; ++i) {
-    input >> mtx[i];
+  return common::readMatrix(input, mtx, rows, cols);
+}
+
+void chernov::addRun(int * cells, size_t count, int value)
+{
+  for (size_t i = 0; i < count; ++i) {
+    cells[i] += value;
+  }
+}
+
+void chernov::addWaveRow(int * row, size_t rows, size_t cols, size_t y)
+{
+  if (rows < 2 || cols < 2) {
+    chernov::addRun(row, cols, 1);
+    return;
+  }
+  const size_t perimeter = 2 * (rows + cols) - 4;
+  const int laps = static_cast< int >(rows * cols / perimeter);
+  const size_t extra = rows * cols % perimeter;
+  const size_t last_row = rows - 1, last_col = cols - 1;
+  if (y == 0) {
+    const size_t lead = extra < cols ? extra : cols;
+    chernov::addRun(row, lead, laps + 1);
+    chernov::addRun(row + lead, cols - lead, laps);
+  } else if (y < last_row) {
+    row[last_col] += laps + (last_col + y < extra);
+    row[0] += laps + (2 * last_col + 2 * last_row - y < extra);
+  } else {
+    row[last_col] += laps + (last_col + last_row < extra);
+    const size_t corner = 2 * last_col + last_row;
+    const size_t tail = extra > corner ? 0 : corner - extra + 1;
+    const size_t start = tail < last_col ? tail : last_col;
+    chernov::addRun(row, start, laps);
+    chernov::addRun(row + start, last_col - start, laps + 1);
   }
-  return input;
 }
 
 void chernov::fllIncWav(int * mtx, size_t rows, size_t cols)
 {
-  int add = 1;
-  size_t x = 0, y = 0, count = 0, border = 0;
-  while (count++ < rows * cols) {
-    mtx[cols * y + x] += add;
-    if (y == border && x != cols - border - 1) {
-      ++x;
-    } else if (x == cols - border - 1 && y != rows - border - 1) {
-      ++y;
-    } else if (y == rows - border - 1 && x != border) {
-      --x;
-    } else if (x == border) {
-      if (y == border - 1) {
-        ++add;
-        ++border;
-        ++x;
-      } else {
-        --y;
-      }
-    }
+  common::Phase phase("fllIncWav", rows * cols);
+  for (size_t y = 0; y < rows; ++y) {
+    chernov::addWaveRow(mtx + cols * y, rows, cols, y);
   }
 }
 
-int chernov::getSumAntiDiagonal(const int * mtx, size_t x, size_t y, size_t rows, size_t cols)
+long long chernov::minAntiSum(const common::DiagonalStats & diagonals)
 {
-  int sum = 0;
-  do {
-    sum += mtx[y * cols + x];
-  } while (x-- > 0 && ++y < rows);
-  return sum;
+  long long min_sum = std::numeric_limits< long long >::max();
+  for (size_t d = 0; d < diagonals.size(); ++d) {
+    long long sum = diagonals.antiSum(d);
+    if (sum < min_sum) {
+      min_sum = sum;
+    }
+  }
+  return min_sum;
 }
 
-int chernov::minSumMdg(const int * mtx, size_t rows, size_t cols)
+long long chernov::minSumMdg(const int * mtx, size_t rows, size_t cols)
 {
+  common::Phase phase("minSumMdg", rows * cols);
   if (rows * cols == 0) {
     return 0;
   }
-  int min_sum = std::numeric_limits< int >::max(), sum = 0;
+  return chernov::minAntiSum(common::scanDiagonals(mtx, rows, cols));
+}
 
-  for (size_t x = 0; x < cols; ++x) {
-    sum = getSumAntiDiagonal(mtx, x, 0, rows, cols);
-    if (sum < min_sum) {
-      min_sum = sum;
-    }
+chernov::WaveRowWriter::WaveRowWriter(common::BufferedWriter & writer, size_t rows, size_t cols):
+  writer_(writer),
+  rows_(rows),
+  row_(0),
+  values_(cols)
+{}
+
+void chernov::WaveRowWriter::operator()(const int *, const int * row, const int *, size_t cols)
+{
+  std::copy(row, row + cols, values_.begin());
+  chernov::addWaveRow(values_.data(), rows_, cols, row_++);
+  writer_ << ' ';
+  writer_.write(values_.data(), cols, ' ');
+}
+
+template< class Scan >
+int chernov::streamResults(std::ostream & output, size_t rows, size_t cols, Scan scan)
+{
+  if (rows * cols == 0) {
+    output << 0 << "\n" << rows << ' ' << cols << "\n";
+    return 0;
   }
-  for (size_t y = 1; y < rows; ++y) {
-    sum = getSumAntiDiagonal(mtx, cols - 1, y, rows, cols);
-    if (sum < min_sum) {
-      min_sum = sum;
+  long long min_sum = 0;
+  try {
+    common::Phase phase("minSumMdg", rows * cols);
+    AntiSums sums = common::makeQueries(common::DiagonalStats(rows, cols));
+    if (!scan(sums)) {
+      std::cerr << "Incorrect input\n";
+      return 2;
     }
+    min_sum = chernov::minAntiSum(sums.get< 0 >());
+  } catch (const std::bad_alloc&) {
+    std::cerr << "Memory allocation failed\n";
+    return 2;
+  } catch (const std::length_error&) {
+    std::cerr << "Memory allocation failed\n";
+    return 2;
   }
-  return min_sum;
+  output << min_sum << "\n";
+  common::BufferedWriter writer(output);
+  writer << rows << ' ' << cols;
+  {
+    common::Phase phase("fllIncWav", rows * cols);
+    WaveRowWriter wave(writer, rows, cols);
+    scan(wave);
+  }
+  writer << '\n';
+  return 0;
 }
 
 int chernov::processMatrix(std::istream & input, std::ostream & output, int * matrix, size_t rows, size_t cols)
@@ -80,20 +169,30 @@ int chernov::processMatrix(std::istream & input, std::ostream & output, int * ma
     std::cerr << "Incorrect input\n";
     return 2;
   }
+  chernov::writeResults(output, matrix, rows, cols);
+  return 0;
+}
 
+void chernov::writeResults(std::ostream & output, int * matrix, size_t rows, size_t cols)
+{
   output << chernov::minSumMdg(matrix, rows, cols) << "\n";
 
   chernov::fllIncWav(matrix, rows, cols);
-  output << rows << " " << cols;
-  for (size_t i = 0; i < rows * cols; ++i) {
-    output << " " << matrix[i];
+  common::BufferedWriter writer(output);
+  writer << rows << ' ' << cols;
+  if (rows * cols != 0) {
+    writer << ' ';
+    writer.write(matrix, rows * cols, ' ');
   }
-  output << "\n";
-
-  return 0;
+  writer << '\n';
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, chernov::run);
+}
+
+int chernov::run(int argc, char ** argv)
 {
   if (argc < 4) {
     std::cerr << "Not enough arguments\n";
@@ -104,28 +203,59 @@ int main(int argc, char ** argv)
   } else if (!std::isdigit(argv[1][0])) {
     std::cerr << "First parameter is not a number\n";
     return 1;
-  } else if (!((argv[1][0] == '1' || argv[1][0] == '2') && argv[1][1] == '\0')) {
+  } else if (!((argv[1][0] >= '1' && argv[1][0] <= '4') && argv[1][1] == '\0')) {
     std::cerr << "First parameter is out of range\n";
     return 1;
   }
 
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], argv[1][0] == '3');
   std::ofstream output(argv[3]);
   size_t rows = 0, cols = 0;
+  int * mapped = nullptr;
+  common::TiledFile tiles;
+  if (argv[1][0] == '4' && tiles.open(argv[2]) && tiles.binaryMatrix(common::ElementType::int32, rows, cols)) {
+    return chernov::streamResults(output, rows, cols, [&tiles, rows, cols](auto & kernel) {
+      return tiles.scanRows< int >(rows, cols, kernel) == rows * cols;
+    });
+  }
+  if (input.binaryMatrix(mapped, rows, cols)) {
+    chernov::writeResults(output, mapped, rows, cols);
+    return 0;
+  }
   input >> rows >> cols;
   if (!input) {
     std::cerr << "Incorrect input\n";
     return 2;
   }
 
+  if (argv[1][0] == '4') {
+    const char * path = argv[2];
+    bool rewind = false;
+    return chernov::streamResults(output, rows, cols, [&input, &rewind, path, rows, cols](auto & kernel) {
+      if (!rewind) {
+        rewind = true;
+        common::streamRows< int >(input, rows, cols, kernel);
+        return static_cast< bool >(input);
+      }
+      common::InputFile again(path, false);
+      size_t header = 0;
+      again >> header >> header;
+      common::streamRows< int >(again, rows, cols, kernel);
+      return static_cast< bool >(again);
+    });
+  }
+
   if (argv[1][0] == '1') {
     constexpr size_t MAX_STATIC_MATRIX_SIZE = 10000;
     int matrix[MAX_STATIC_MATRIX_SIZE] = {};
     return chernov::processMatrix(input, output, matrix, rows, cols);
   }
 
-  int * matrix = new int[rows * cols];
-  int result = chernov::processMatrix(input, output, matrix, rows, cols);
-  delete [] matrix;
-  return result;
+  common::Arena arena(common::Arena::bytes< int >(rows * cols));
+  int * matrix = arena.allocate< int >(rows * cols);
+  if (!matrix) {
+    std::cerr << "Memory allocation failed\n";
+    return 2;
+  }
+  return chernov::processMatrix(input, output, matrix, rows, cols);
 }
@@ -0,0 +1,169 @@
+#include <alloc_profile.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <matrix_writer.hpp>
+
+namespace
+{
+  std::atomic< int > profiling(-1);
+  std::atomic< unsigned long long > allocations(0);
+  std::atomic< unsigned long long > allocated(0);
+  std::atomic< unsigned long long > live(0);
+  std::atomic< unsigned long long > peak(0);
+
+  bool enabled()
+  {
+    int state = profiling.load(std::memory_order_relaxed);
+    if (state < 0)
+    {
+      const char * value = std::getenv("ALLOC_PROFILE");
+      state = value && *value && std::strcmp(value, "0") != 0;
+      profiling.store(state, std::memory_order_relaxed);
+    }
+    return state != 0;
+  }
+
+#ifdef __GLIBC__
+  void * allocate(size_t size)
+  {
+    void * block = std::malloc(size ? size : 1);
+    while (!block)
+    {
+      const std::new_handler handler = std::get_new_handler();
+      if (!handler)
+      {
+        throw std::bad_alloc();
+      }
+      handler();
+      block = std::malloc(size ? size : 1);
+    }
+    if (enabled())
+    {
+      common::recordAllocation(malloc_usable_size(block));
+    }
+    return block;
+  }
+
+  void * allocateNothrow(size_t size) noexcept
+  {
+    try
+    {
+      return allocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+      return nullptr;
+    }
+  }
+
+  void deallocate(void * block)
+  {
+    if (block && enabled())
+    {
+      common::recordRelease(malloc_usable_size(block));
+    }
+    std::free(block);
+  }
+#endif
+}
+
+bool common::allocationProfile()
+{
+  return enabled();
+}
+
+void common::recordAllocation(size_t bytes)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated.fetch_add(bytes, std::memory_order_relaxed);
+  const unsigned long long now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  unsigned long long top = peak.load(std::memory_order_relaxed);
+  while (now > top && !peak.compare_exchange_weak(top, now, std::memory_order_relaxed))
+  {}
+}
+
+void common::recordRelease(size_t bytes)
+{
+  live.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+common::AllocationStats common::allocationStats()
+{
+  AllocationStats stats = { allocations.load(), allocated.load(), peak.load() };
+  return stats;
+}
+
+void common::printAllocations(std::ostream & out, const AllocationStats & stats, size_t cells)
+{
+  BufferedWriter writer(out);
+  writer << "allocations " << static_cast< size_t >(stats.allocations) << '\n';
+  writer << "allocated bytes " << static_cast< size_t >(stats.bytes) << '\n';
+  writer << "peak bytes " << static_cast< size_t >(stats.peak) << '\n';
+  writer << "peak bytes/cell ";
+  if (cells)
+  {
+    writer << static_cast< double >(stats.peak) / static_cast< double >(cells);
+  }
+  else
+  {
+    writer << '-';
+  }
+  writer << '\n';
+}
+
+#ifdef __GLIBC__
+void * operator new(size_t size)
+{
+  return allocate(size);
+}
+
+void * operator new[](size_t size)
+{
+  return allocate(size);
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  return allocateNothrow(size);
+}
+
+void * operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  return allocateNothrow(size);
+}
+
+void operator delete(void * block) noexcept
+{
+  deallocate(block);
+}
+
+void operator delete[](void * block) noexcept
+{
+  deallocate(block);
+}
+
+void operator delete(void * block, size_t) noexcept
+{
+  deallocate(block);
+}
+
+void operator delete[](void * block, size_t) noexcept
+{
+  deallocate(block);
+}
+
+void operator delete(void * block, const std::nothrow_t &) noexcept
+{
+  deallocate(block);
+}
+
+void operator delete[](void * block, const std::nothrow_t &) noexcept
+{
+  deallocate(block);
+}
+#endif
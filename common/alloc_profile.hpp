@@ -0,0 +1,23 @@
+#ifndef ALLOC_PROFILE_HPP
+#define ALLOC_PROFILE_HPP
+
+#include <cstddef>
+#include <ostream>
+
+namespace common
+{
+  struct AllocationStats
+  {
+    unsigned long long allocations;
+    unsigned long long bytes;
+    unsigned long long peak;
+  };
+
+  bool allocationProfile();
+  void recordAllocation(size_t bytes);
+  void recordRelease(size_t bytes);
+  AllocationStats allocationStats();
+  void printAllocations(std::ostream & out, const AllocationStats & stats, size_t cells);
+}
+
+#endif
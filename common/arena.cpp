@@ -0,0 +1,109 @@
+#include <arena.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <alloc_profile.hpp>
+
+namespace
+{
+  struct SpareBlock
+  {
+    char * storage;
+    size_t size;
+
+    ~SpareBlock()
+    {
+      std::free(storage);
+    }
+  };
+
+  thread_local SpareBlock spare = { nullptr, 0 };
+}
+
+common::Arena::Arena(size_t bytes):
+  storage_(nullptr),
+  base_(nullptr),
+  reserved_(0),
+  capacity_(0),
+  used_(0)
+{
+  if (bytes > std::numeric_limits< size_t >::max() - ALIGNMENT)
+  {
+    return;
+  }
+  if (spare.storage && spare.size >= bytes + ALIGNMENT)
+  {
+    storage_ = spare.storage;
+    reserved_ = spare.size;
+    spare.storage = nullptr;
+    spare.size = 0;
+  }
+  else
+  {
+    storage_ = static_cast< char * >(std::malloc(bytes + ALIGNMENT));
+    reserved_ = storage_ ? bytes + ALIGNMENT : 0;
+    if (storage_ && allocationProfile())
+    {
+      recordAllocation(reserved_);
+    }
+  }
+  if (storage_)
+  {
+    const uintptr_t address = reinterpret_cast< uintptr_t >(storage_);
+    base_ = storage_ + (ALIGNMENT - address % ALIGNMENT) % ALIGNMENT;
+    capacity_ = bytes;
+  }
+}
+
+common::Arena::~Arena()
+{
+  const bool profile = allocationProfile();
+  if (reserved_ > spare.size && reserved_ <= SPARE_LIMIT)
+  {
+    if (spare.storage && profile)
+    {
+      recordRelease(spare.size);
+    }
+    std::free(spare.storage);
+    spare.storage = storage_;
+    spare.size = reserved_;
+  }
+  else
+  {
+    if (storage_ && profile)
+    {
+      recordRelease(reserved_);
+    }
+    std::free(storage_);
+  }
+}
+
+size_t common::Arena::spareBytes()
+{
+  return spare.size;
+}
+
+size_t common::Arena::capacity() const
+{
+  return capacity_;
+}
+
+size_t common::Arena::used() const
+{
+  return used_;
+}
+
+void common::Arena::release()
+{
+  used_ = 0;
+}
+
+void * common::Arena::take(size_t size)
+{
+  if (!base_ || size > capacity_ - used_)
+  {
+    return nullptr;
+  }
+  void * block = base_ + used_;
+  used_ += size;
+  return block;
+}
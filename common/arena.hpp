@@ -0,0 +1,77 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace common
+{
+  class Arena
+  {
+  public:
+    static const size_t ALIGNMENT = 64;
+    static const size_t SPARE_LIMIT = size_t(1) << 24;
+
+    explicit Arena(size_t bytes);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena & operator=(const Arena &) = delete;
+
+    size_t capacity() const;
+    size_t used() const;
+    void release();
+    template< class T >
+    T * allocate(size_t count);
+    template< class T >
+    T * allocateArray(size_t count);
+
+    template< class T >
+    static size_t bytes(size_t count);
+    static size_t spareBytes();
+
+  private:
+    char * storage_;
+    char * base_;
+    size_t reserved_;
+    size_t capacity_;
+    size_t used_;
+
+    void * take(size_t size);
+  };
+}
+
+template< class T >
+T * common::Arena::allocate(size_t count)
+{
+  const size_t size = bytes< T >(count);
+  return size == 0 && count != 0 ? nullptr : static_cast< T * >(take(size));
+}
+
+template< class T >
+T * common::Arena::allocateArray(size_t count)
+{
+  if (bytes< T >(count) == 0 && count != 0)
+  {
+    throw std::bad_array_new_length();
+  }
+  T * result = allocate< T >(count);
+  if (!result)
+  {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+template< class T >
+size_t common::Arena::bytes(size_t count)
+{
+  const size_t limit = (std::numeric_limits< size_t >::max() - ALIGNMENT) / sizeof(T);
+  if (count > limit)
+  {
+    return 0;
+  }
+  return (count * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+#endif
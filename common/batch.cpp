@@ -0,0 +1,166 @@
+#include <batch.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <alloc_profile.hpp>
+#include <bench.hpp>
+#include <numa.hpp>
+#include <parallel.hpp>
+#include <phase.hpp>
+#include <result_cache.hpp>
+
+namespace
+{
+  struct BatchEntry
+  {
+    std::string mode;
+    std::string input;
+    std::string output;
+  };
+
+  bool readManifest(std::istream & manifest, std::vector< BatchEntry > & entries)
+  {
+    std::string line;
+    size_t number = 0;
+    while (std::getline(manifest, line))
+    {
+      ++number;
+      std::istringstream fields(line);
+      BatchEntry entry;
+      if (!(fields >> entry.mode) || entry.mode[0] == '#')
+      {
+        continue;
+      }
+      std::string extra;
+      if (!(fields >> entry.input >> entry.output) || fields >> extra)
+      {
+        std::cerr << "Manifest line " << number << ": expected mode, input and output\n";
+        return false;
+      }
+      entries.push_back(entry);
+    }
+    return true;
+  }
+
+  int runEntry(const char * program, BatchEntry & entry, common::Job job)
+  {
+    std::vector< char > name(program, program + std::strlen(program) + 1);
+    char * argv[] = { name.data(), &entry.mode[0], &entry.input[0], &entry.output[0], nullptr };
+    return common::runCached(4, argv, job);
+  }
+
+  size_t largestCells(const std::vector< common::PhaseTotal > & totals)
+  {
+    size_t cells = 0;
+    for (const common::PhaseTotal & total : totals)
+    {
+      const size_t perCall = total.calls ? total.cells / total.calls : 0;
+      cells = perCall > cells ? perCall : cells;
+    }
+    return cells;
+  }
+
+  int runJobs(int argc, char ** argv, common::Job job)
+  {
+    if (argc != 3 || std::strcmp(argv[1], "--batch") != 0)
+    {
+      return common::runCached(argc, argv, job);
+    }
+    std::ifstream manifest(argv[2]);
+    if (!manifest)
+    {
+      std::cerr << "Can't open manifest\n";
+      return 2;
+    }
+    std::vector< BatchEntry > entries;
+    if (!readManifest(manifest, entries))
+    {
+      return 1;
+    }
+    std::vector< int > codes(entries.size(), 0);
+    std::atomic< size_t > next(0);
+    auto work = [&]()
+    {
+      for (size_t i = next++; i < entries.size(); i = next++)
+      {
+        codes[i] = runEntry(argv[0], entries[i], job);
+      }
+    };
+    const size_t jobs = common::batchJobs() < entries.size() ? common::batchJobs() : entries.size();
+    if (jobs > 1)
+    {
+      common::ThreadPool::shared().run(jobs, [&work](size_t)
+      {
+        work();
+      });
+    }
+    else
+    {
+      work();
+    }
+    int result = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      if (codes[i] != 0)
+      {
+        std::cerr << entries[i].input << ": exit code " << codes[i] << '\n';
+        result = result ? result : codes[i];
+      }
+    }
+    return result;
+  }
+}
+
+size_t common::batchJobs()
+{
+  const char * value = std::getenv("MATRIX_BATCH_JOBS");
+  if (value && *value)
+  {
+    const long jobs = std::strtol(value, nullptr, 10);
+    return jobs > 0 ? static_cast< size_t >(jobs) : 1;
+  }
+  return 1;
+}
+
+int common::runBatch(int argc, char ** argv, Job job)
+{
+  if (argc >= 2 && std::strcmp(argv[1], "--bench") == 0)
+  {
+    return runBench(argc, argv, job);
+  }
+  const bool phases = phaseSummary();
+  const bool allocations = allocationProfile();
+  if (!phases && !allocations)
+  {
+    return runJobs(argc, argv, job);
+  }
+  Phase::enable(true);
+  const bool numa = phases && numaPlacement();
+  trackNuma(numa);
+  int code = 0;
+  {
+    Phase phase("total", 0);
+    code = runJobs(argc, argv, job);
+  }
+  Phase::enable(false);
+  const std::vector< PhaseTotal > totals = Phase::collect();
+  if (phases)
+  {
+    printPhases(std::cerr, totals);
+  }
+  if (numa)
+  {
+    printNuma(std::cerr, numaTraffic());
+    trackNuma(false);
+  }
+  if (allocations)
+  {
+    printAllocations(std::cerr, allocationStats(), largestCells(totals));
+  }
+  return code;
+}
@@ -0,0 +1,14 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+
+namespace common
+{
+  using Job = int (*)(int argc, char ** argv);
+
+  size_t batchJobs();
+  int runBatch(int argc, char ** argv, Job job);
+}
+
+#endif
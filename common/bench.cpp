@@ -0,0 +1,443 @@
+#include <bench.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <matrix_writer.hpp>
+#include <perf_counters.hpp>
+#include <phase.hpp>
+#include <simd_kernels.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+  struct BenchOptions
+  {
+    std::string mode;
+    std::vector< common::BenchShape > shapes;
+    std::vector< size_t > cells;
+    size_t reps;
+    unsigned seed;
+    std::string keep;
+    bool counters;
+    std::string json;
+  };
+
+  struct BenchRecord
+  {
+    const char * shape;
+    size_t rows;
+    size_t cols;
+    common::PhaseTotal total;
+  };
+
+  const char * const SHAPE_NAMES[] = { "square", "tall", "wide", "sparse" };
+  const size_t TALL_RATIO = 16;
+
+  std::vector< std::string > split(const char * list)
+  {
+    std::vector< std::string > items;
+    std::string item;
+    for (const char * c = list; ; ++c)
+    {
+      if (*c == ',' || *c == '\0')
+      {
+        if (!item.empty())
+        {
+          items.push_back(item);
+        }
+        item.clear();
+        if (*c == '\0')
+        {
+          return items;
+        }
+      }
+      else
+      {
+        item += *c;
+      }
+    }
+  }
+
+  bool parseCount(const std::string & text, size_t & value)
+  {
+    char * end = nullptr;
+    const unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed == 0)
+    {
+      return false;
+    }
+    value = parsed;
+    return true;
+  }
+
+  bool parseOption(const char * arg, BenchOptions & options)
+  {
+    const char * value = std::strchr(arg, '=');
+    if (!value)
+    {
+      return false;
+    }
+    const std::string key(arg, value++);
+    if (key == "mode")
+    {
+      options.mode = value;
+      return !options.mode.empty();
+    }
+    if (key == "shapes")
+    {
+      options.shapes.clear();
+      for (const std::string & name : split(value))
+      {
+        common::BenchShape shape = common::BenchShape::square;
+        if (!common::parseShape(name.c_str(), shape))
+        {
+          return false;
+        }
+        options.shapes.push_back(shape);
+      }
+      return !options.shapes.empty();
+    }
+    if (key == "cells")
+    {
+      options.cells.clear();
+      for (const std::string & text : split(value))
+      {
+        size_t cells = 0;
+        if (!parseCount(text, cells))
+        {
+          return false;
+        }
+        options.cells.push_back(cells);
+      }
+      return !options.cells.empty();
+    }
+    if (key == "keep")
+    {
+      options.keep = value;
+      return !options.keep.empty();
+    }
+    if (key == "json")
+    {
+      options.json = value;
+      return !options.json.empty();
+    }
+    if (key == "counters" && (!std::strcmp(value, "0") || !std::strcmp(value, "1")))
+    {
+      options.counters = *value == '1';
+      return true;
+    }
+    size_t number = 0;
+    if (key == "reps" && parseCount(value, number))
+    {
+      options.reps = number;
+      return true;
+    }
+    if (key == "seed" && parseCount(value, number))
+    {
+      options.seed = static_cast< unsigned >(number);
+      return true;
+    }
+    return false;
+  }
+
+  std::string temporaryFile(const char * tag)
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    const char * dir = std::getenv("TMPDIR");
+    std::string path = std::string(dir && *dir ? dir : "/tmp") + "/matrix-bench-" + tag + "-XXXXXX";
+    const int fd = mkstemp(&path[0]);
+    if (fd < 0)
+    {
+      return std::string();
+    }
+    close(fd);
+    return path;
+#else
+    const char * dir = std::getenv("TEMP");
+    return std::string(dir && *dir ? dir : ".") + "/matrix-bench-" + tag + ".tmp";
+#endif
+  }
+
+  bool keepFile(const std::string & from, const std::string & to)
+  {
+    if (std::rename(from.c_str(), to.c_str()) == 0)
+    {
+      return true;
+    }
+    bool copied = false;
+    {
+      std::ifstream input(from, std::ios::binary);
+      std::ofstream output(to, std::ios::binary);
+      copied = input && output && (input.peek() == std::ifstream::traits_type::eof() || output << input.rdbuf());
+    }
+    std::remove(from.c_str());
+    return copied;
+  }
+
+  double perCell(unsigned long long nanoseconds, unsigned long long cells)
+  {
+    return cells ? static_cast< double >(nanoseconds) / static_cast< double >(cells) : 0.0;
+  }
+
+  void writeRatio(common::BufferedWriter & writer, const common::CounterValues & counters, common::Counter counter,
+      unsigned long long divisor)
+  {
+    writer << ' ';
+    if (counters.has(counter) && divisor)
+    {
+      writer << static_cast< double >(counters.get(counter)) / static_cast< double >(divisor);
+    }
+    else
+    {
+      writer << '-';
+    }
+  }
+
+  void writeJsonString(common::BufferedWriter & writer, const char * text)
+  {
+    writer << '"';
+    for (const char * c = text; *c; ++c)
+    {
+      if (*c == '"' || *c == '\\')
+      {
+        writer << '\\';
+      }
+      writer << *c;
+    }
+    writer << '"';
+  }
+
+  void writeJsonRatio(common::BufferedWriter & writer, const char * key, const common::CounterValues & counters,
+      common::Counter counter, unsigned long long divisor)
+  {
+    writer << ", \"" << key << "\": ";
+    if (counters.has(counter) && divisor)
+    {
+      writer << static_cast< double >(counters.get(counter)) / static_cast< double >(divisor);
+    }
+    else
+    {
+      writer << "null";
+    }
+  }
+
+  bool writeJson(const std::string & path, const BenchOptions & options, const std::vector< BenchRecord > & records)
+  {
+    std::ofstream file(path);
+    if (!file)
+    {
+      return false;
+    }
+    {
+      common::BufferedWriter writer(file);
+      writer << "{\n  \"mode\": ";
+      writeJsonString(writer, options.mode.c_str());
+      writer << ",\n  \"reps\": " << options.reps << ",\n  \"seed\": " << static_cast< size_t >(options.seed);
+      writer << ",\n  \"isa\": ";
+      writeJsonString(writer, common::simd::kernels().isa);
+      writer << ",\n  \"results\": [";
+      for (size_t i = 0; i < records.size(); ++i)
+      {
+        const BenchRecord & record = records[i];
+        const common::PhaseTotal & total = record.total;
+        writer << (i ? ",\n" : "\n") << "    { \"shape\": ";
+        writeJsonString(writer, record.shape);
+        writer << ", \"rows\": " << record.rows << ", \"cols\": " << record.cols << ", \"phase\": ";
+        writeJsonString(writer, total.name.c_str());
+        writer << ", \"calls\": " << total.calls << ", \"ns_per_cell\": " << perCell(total.nanoseconds, total.cells);
+        if (options.counters)
+        {
+          const common::CounterValues & values = total.counters;
+          const bool cycles = values.has(common::Counter::cycles);
+          writeJsonRatio(writer, "ipc", values, common::Counter::instructions,
+              cycles ? values.get(common::Counter::cycles) : 0);
+          writeJsonRatio(writer, "llc_per_cell", values, common::Counter::llc_misses, total.cells);
+          writeJsonRatio(writer, "brmiss_per_cell", values, common::Counter::branch_misses, total.cells);
+        }
+        writer << " }";
+      }
+      writer << "\n  ]\n}\n";
+    }
+    return static_cast< bool >(file);
+  }
+
+  void report(std::ostream & out, const char * shape, size_t rows, size_t cols, const common::PhaseTotal & total,
+      bool counters)
+  {
+    common::BufferedWriter writer(out);
+    writer << shape << ' ' << rows << ' ' << cols << ' ' << total.name.c_str() << ' ' << total.calls << ' ';
+    writer << perCell(total.nanoseconds, total.cells);
+    if (counters)
+    {
+      const common::CounterValues & values = total.counters;
+      const bool cycles = values.has(common::Counter::cycles);
+      writeRatio(writer, values, common::Counter::instructions, cycles ? values.get(common::Counter::cycles) : 0);
+      writeRatio(writer, values, common::Counter::llc_misses, total.cells);
+      writeRatio(writer, values, common::Counter::branch_misses, total.cells);
+    }
+    writer << '\n';
+  }
+
+  int benchCase(char * program, const BenchOptions & options, common::BenchShape shape, size_t cells,
+      common::Job job, const common::PerfCounters * counters, std::vector< BenchRecord > & records)
+  {
+    size_t rows = 0, cols = 0;
+    common::shapeSize(shape, cells, rows, cols);
+    std::string input = temporaryFile("in");
+    std::string output = temporaryFile("out");
+    if (input.empty() || output.empty())
+    {
+      std::cerr << "Can't create benchmark files\n";
+      return 2;
+    }
+    {
+      std::ofstream file(input);
+      common::generateMatrix(file, shape, rows, cols, options.seed);
+    }
+    std::string mode = options.mode;
+    char * args[] = { program, &mode[0], &input[0], &output[0], nullptr };
+    int code = 0;
+    common::PhaseTotal total = { "total", 0, 0, 0, 0, common::noCounters() };
+    common::Phase::collect();
+    common::Phase::enable(true);
+    for (size_t rep = 0; rep < options.reps && code == 0; ++rep)
+    {
+      const common::CounterValues begin = counters ? counters->read() : common::noCounters();
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      code = job(4, args);
+      const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+      total.counters.add(begin, counters ? counters->read() : common::noCounters());
+      ++total.calls;
+      total.nanoseconds += std::chrono::duration_cast< std::chrono::nanoseconds >(elapsed).count();
+      total.cells += rows * cols;
+    }
+    common::Phase::enable(false);
+    std::vector< common::PhaseTotal > totals = common::Phase::collect();
+    totals.insert(totals.begin(), total);
+    for (const common::PhaseTotal & phase : totals)
+    {
+      report(std::cout, common::shapeName(shape), rows, cols, phase, options.counters);
+      const BenchRecord record = { common::shapeName(shape), rows, cols, phase };
+      records.push_back(record);
+    }
+    std::remove(input.c_str());
+    if (options.keep.empty())
+    {
+      std::remove(output.c_str());
+    }
+    else
+    {
+      const std::string kept = options.keep + '.' + common::shapeName(shape) + '.' + std::to_string(rows) + 'x'
+          + std::to_string(cols);
+      if (!keepFile(output, kept))
+      {
+        std::cerr << "Can't keep benchmark output " << kept << '\n';
+        code = code ? code : 2;
+      }
+    }
+    if (code != 0)
+    {
+      std::cerr << common::shapeName(shape) << ' ' << rows << 'x' << cols << ": exit code " << code << '\n';
+    }
+    return code;
+  }
+}
+
+bool common::parseShape(const char * name, BenchShape & shape)
+{
+  for (size_t i = 0; i < sizeof(SHAPE_NAMES) / sizeof(SHAPE_NAMES[0]); ++i)
+  {
+    if (std::strcmp(name, SHAPE_NAMES[i]) == 0)
+    {
+      shape = static_cast< BenchShape >(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char * common::shapeName(BenchShape shape)
+{
+  return SHAPE_NAMES[static_cast< size_t >(shape)];
+}
+
+void common::shapeSize(BenchShape shape, size_t cells, size_t & rows, size_t & cols)
+{
+  const size_t ratio = shape == BenchShape::tall || shape == BenchShape::wide ? TALL_RATIO : 1;
+  const double side = std::sqrt(static_cast< double >(cells) / static_cast< double >(ratio));
+  const size_t narrow = side < 1.0 ? 1 : static_cast< size_t >(side + 0.5);
+  const size_t wide = cells / narrow ? cells / narrow : 1;
+  rows = shape == BenchShape::wide ? narrow : wide;
+  cols = shape == BenchShape::wide ? wide : narrow;
+}
+
+void common::generateMatrix(std::ostream & output, BenchShape shape, size_t rows, size_t cols, unsigned seed)
+{
+  std::mt19937 random(seed);
+  std::uniform_int_distribution< int > values(-99, 99);
+  std::uniform_int_distribution< int > percent(0, 99);
+  const int zeros = shape == BenchShape::sparse ? 90 : 0;
+  BufferedWriter writer(output);
+  writer << rows << ' ' << cols << '\n';
+  for (size_t i = 0; i < rows; ++i)
+  {
+    for (size_t j = 0; j < cols; ++j)
+    {
+      const int value = percent(random) < zeros ? 0 : values(random);
+      writer << value << (j + 1 < cols ? ' ' : '\n');
+    }
+  }
+}
+
+int common::runBench(int argc, char ** argv, Job job)
+{
+  BenchOptions options = { "2", { BenchShape::square, BenchShape::tall, BenchShape::wide, BenchShape::sparse },
+      { 1000000 }, 3, 1, std::string(), false, std::string() };
+  for (int i = 2; i < argc; ++i)
+  {
+    if (!parseOption(argv[i], options))
+    {
+      std::cerr << "Bad benchmark option " << argv[i] << '\n';
+      return 1;
+    }
+  }
+  std::unique_ptr< common::PerfCounters > counters;
+  if (options.counters)
+  {
+    setenv("MATRIX_THREADS", "1", 1);
+    counters.reset(new common::PerfCounters);
+    if (!counters->available())
+    {
+      std::cerr << "Hardware counters are unavailable\n";
+    }
+  }
+  common::Phase::attach(counters.get());
+  std::cout << "shape rows cols phase calls ns/cell" << (options.counters ? " ipc llc/cell brmiss/cell" : "") << '\n';
+  int result = 0;
+  std::vector< BenchRecord > records;
+  for (size_t s = 0; s < options.shapes.size(); ++s)
+  {
+    for (size_t c = 0; c < options.cells.size(); ++c)
+    {
+      const int code = benchCase(argv[0], options, options.shapes[s], options.cells[c], job, counters.get(), records);
+      result = result ? result : code;
+    }
+  }
+  common::Phase::attach(nullptr);
+  if (!options.json.empty() && !writeJson(options.json, options, records))
+  {
+    std::cerr << "Can't write benchmark results " << options.json << '\n';
+    result = result ? result : 2;
+  }
+  return result;
+}
@@ -0,0 +1,26 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <batch.hpp>
+
+namespace common
+{
+  enum class BenchShape
+  {
+    square,
+    tall,
+    wide,
+    sparse
+  };
+
+  bool parseShape(const char * name, BenchShape & shape);
+  const char * shapeName(BenchShape shape);
+  void shapeSize(BenchShape shape, size_t cells, size_t & rows, size_t & cols);
+  void generateMatrix(std::ostream & output, BenchShape shape, size_t rows, size_t cols, unsigned seed);
+
+  int runBench(int argc, char ** argv, Job job);
+}
+
+#endif
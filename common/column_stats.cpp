@@ -0,0 +1,148 @@
+#include <column_stats.hpp>
+#include <algorithm>
+#include <limits>
+#include <simd_kernels.hpp>
+
+namespace
+{
+  const size_t WORD_BITS = 64;
+
+  template< class T >
+  size_t clearRepeats(const T * row, const T * below, size_t cols, uint64_t * unique)
+  {
+    const common::simd::TypeKernels< T > & kernels = common::simd::kernelsFor< T >();
+    size_t remaining = 0;
+    for (size_t w = 0; w * WORD_BITS < cols; ++w)
+    {
+      if (unique[w] == 0)
+      {
+        continue;
+      }
+      const size_t from = w * WORD_BITS;
+      const size_t to = cols - from < WORD_BITS ? cols : from + WORD_BITS;
+      unique[w] &= ~kernels.equal_mask(row, below, from, to);
+      remaining += __builtin_popcountll(unique[w]);
+    }
+    return remaining;
+  }
+}
+
+size_t common::clearColumnRepeats(const std::int8_t * row, const std::int8_t * below, size_t cols, uint64_t * unique)
+{
+  return clearRepeats(row, below, cols, unique);
+}
+
+size_t common::clearColumnRepeats(const std::int16_t * row, const std::int16_t * below, size_t cols,
+    uint64_t * unique)
+{
+  return clearRepeats(row, below, cols, unique);
+}
+
+size_t common::clearColumnRepeats(const int * row, const int * below, size_t cols, uint64_t * unique)
+{
+  return clearRepeats(row, below, cols, unique);
+}
+
+size_t common::clearColumnRepeats(const long long * row, const long long * below, size_t cols, uint64_t * unique)
+{
+  return clearRepeats(row, below, cols, unique);
+}
+
+void common::updateColumnRuns(const int * row, const int * below, size_t cols, int * run, int * best)
+{
+  simd::kernels().column_runs(row, below, cols, run, best);
+}
+
+common::ColumnRuns::ColumnRuns(size_t cols):
+  run_(cols, 0),
+  best_(cols, 0)
+{}
+
+void common::ColumnRuns::operator()(const int *, const int * row, const int * below, size_t cols)
+{
+  if (below)
+  {
+    updateColumnRuns(row, below, cols, run_.data(), best_.data());
+  }
+}
+
+size_t common::ColumnRuns::longest() const
+{
+  int length = 0;
+  size_t column = 0;
+  for (size_t j = 0; j < best_.size(); ++j)
+  {
+    if (best_[j] > length)
+    {
+      length = best_[j];
+      column = j + 1;
+    }
+  }
+  return column;
+}
+
+common::SaddlePoints::SaddlePoints(size_t cols):
+  col_max_(cols, std::numeric_limits< int >::min()),
+  candidate_(cols, std::numeric_limits< int >::min()),
+  candidates_(cols, 0)
+{}
+
+void common::SaddlePoints::operator()(const int *, const int * row, const int *, size_t cols)
+{
+  if (cols == 0)
+  {
+    return;
+  }
+  const int low = *std::min_element(row, row + cols);
+  int * col_max = col_max_.data();
+  for (size_t j = 0; j < cols; ++j)
+  {
+    col_max[j] = std::max(col_max[j], row[j]);
+  }
+  for (size_t j = 0; j < cols; ++j)
+  {
+    if (row[j] != low || low < candidate_[j])
+    {
+      continue;
+    }
+    candidates_[j] = low == candidate_[j] ? candidates_[j] + 1 : 1;
+    candidate_[j] = low;
+  }
+}
+
+void common::SaddlePoints::merge(const SaddlePoints & other)
+{
+  for (size_t j = 0; j < col_max_.size(); ++j)
+  {
+    col_max_[j] = std::max(col_max_[j], other.col_max_[j]);
+    if (other.candidate_[j] > candidate_[j])
+    {
+      candidate_[j] = other.candidate_[j];
+      candidates_[j] = other.candidates_[j];
+    }
+    else if (other.candidate_[j] == candidate_[j])
+    {
+      candidates_[j] += other.candidates_[j];
+    }
+  }
+}
+
+size_t common::SaddlePoints::count() const
+{
+  size_t points = 0;
+  for (size_t j = 0; j < col_max_.size(); ++j)
+  {
+    points += candidate_[j] == col_max_[j] ? candidates_[j] : 0;
+  }
+  return points;
+}
+
+size_t common::countBits(const uint64_t * words, size_t count)
+{
+  size_t bits = 0;
+  for (size_t w = 0; w < count; ++w)
+  {
+    bits += __builtin_popcountll(words[w]);
+  }
+  return bits;
+}
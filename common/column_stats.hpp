@@ -0,0 +1,95 @@
+#ifndef COLUMN_STATS_HPP
+#define COLUMN_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace common
+{
+  size_t clearColumnRepeats(const std::int8_t * row, const std::int8_t * below, size_t cols, uint64_t * unique);
+  size_t clearColumnRepeats(const std::int16_t * row, const std::int16_t * below, size_t cols, uint64_t * unique);
+  size_t clearColumnRepeats(const int * row, const int * below, size_t cols, uint64_t * unique);
+  size_t clearColumnRepeats(const long long * row, const long long * below, size_t cols, uint64_t * unique);
+  size_t countBits(const uint64_t * words, size_t count);
+  void updateColumnRuns(const int * row, const int * below, size_t cols, int * run, int * best);
+
+  class ColumnRuns
+  {
+  public:
+    explicit ColumnRuns(size_t cols);
+    void operator()(const int * above, const int * row, const int * below, size_t cols);
+    size_t longest() const;
+
+  private:
+    std::vector< int > run_;
+    std::vector< int > best_;
+  };
+
+  class SaddlePoints
+  {
+  public:
+    explicit SaddlePoints(size_t cols);
+    void operator()(const int * above, const int * row, const int * below, size_t cols);
+    void merge(const SaddlePoints & other);
+    size_t count() const;
+
+  private:
+    std::vector< int > col_max_;
+    std::vector< int > candidate_;
+    std::vector< size_t > candidates_;
+  };
+
+  template< class T >
+  class ColumnRepeats
+  {
+  public:
+    explicit ColumnRepeats(size_t cols);
+    void operator()(const T * above, const T * row, const T * below, size_t cols);
+    void merge(const ColumnRepeats & other);
+    size_t distinct() const;
+
+  private:
+    std::vector< uint64_t > unique_;
+    size_t remaining_;
+  };
+}
+
+template< class T >
+common::ColumnRepeats< T >::ColumnRepeats(size_t cols):
+  unique_((cols + 63) / 64, ~uint64_t(0)),
+  remaining_(cols)
+{
+  if (cols % 64 != 0)
+  {
+    unique_.back() = (uint64_t(1) << cols % 64) - 1;
+  }
+}
+
+template< class T >
+void common::ColumnRepeats< T >::operator()(const T *, const T * row, const T * below, size_t cols)
+{
+  if (!below || remaining_ == 0)
+  {
+    return;
+  }
+  remaining_ = clearColumnRepeats(row, below, cols, unique_.data());
+}
+
+template< class T >
+void common::ColumnRepeats< T >::merge(const ColumnRepeats & other)
+{
+  for (size_t w = 0; w < unique_.size(); ++w)
+  {
+    unique_[w] &= other.unique_[w];
+  }
+  remaining_ = countBits(unique_.data(), unique_.size());
+}
+
+template< class T >
+size_t common::ColumnRepeats< T >::distinct() const
+{
+  return remaining_;
+}
+
+#endif
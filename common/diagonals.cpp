@@ -0,0 +1,187 @@
+#include <diagonals.hpp>
+#include <algorithm>
+#include <parallel.hpp>
+
+namespace
+{
+  size_t diagonalCount(size_t rows, size_t cols)
+  {
+    return rows && cols ? rows + cols - 1 : 0;
+  }
+
+  template< class T >
+  common::DiagonalStats scanAll(const common::MatrixView< const T > & mtx)
+  {
+    common::DiagonalStats stats(mtx.rows(), mtx.cols());
+    if (stats.size() != 0)
+    {
+      common::parallelTiles(mtx.rows(), mtx.cols(), stats, [&mtx](common::DiagonalStats & part, size_t begin,
+          size_t end)
+      {
+        common::recordTile(mtx.row(begin), (end - begin) * mtx.stride() * sizeof(T));
+        part.addRows(mtx, begin, end);
+      });
+    }
+    return stats;
+  }
+}
+
+common::DiagonalStats::DiagonalStats(size_t rows, size_t cols):
+  rows_(rows),
+  cols_(cols),
+  main_sum_(diagonalCount(rows, cols), 0),
+  anti_sum_(diagonalCount(rows, cols), 0),
+  main_zeros_(diagonalCount(rows, cols), 0),
+  anti_zeros_(diagonalCount(rows, cols), 0)
+{}
+
+common::DiagonalStats common::DiagonalStats::zeros(size_t rows, size_t cols)
+{
+  DiagonalStats stats(rows, cols);
+  for (size_t d = 0; d < stats.size(); ++d)
+  {
+    stats.main_zeros_[d] = stats.mainLength(d);
+    stats.anti_zeros_[d] = stats.antiLength(d);
+  }
+  return stats;
+}
+
+template< class T >
+void common::DiagonalStats::addRows(const MatrixView< const T > & mtx, size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; ++i)
+  {
+    addRow(i, mtx.row(i));
+  }
+}
+
+template< class T >
+void common::DiagonalStats::addRow(size_t i, const T * row)
+{
+  long long * main_sum = main_sum_.data() + mainIndex(i, 0);
+  long long * anti_sum = anti_sum_.data() + antiIndex(i, 0);
+  size_t * main_zeros = main_zeros_.data() + mainIndex(i, 0);
+  size_t * anti_zeros = anti_zeros_.data() + antiIndex(i, 0);
+  for (size_t j = 0; j < cols_; ++j)
+  {
+    main_sum[j] += row[j];
+    anti_sum[j] += row[j];
+  }
+  for (size_t j = 0; j < cols_; ++j)
+  {
+    main_zeros[j] += row[j] == 0;
+    anti_zeros[j] += row[j] == 0;
+  }
+}
+
+template< class T >
+void common::DiagonalStats::operator()(size_t i, const T *, const T * row, const T *, size_t)
+{
+  if (i < rows_)
+  {
+    addRow(i, row);
+  }
+}
+
+void common::DiagonalStats::merge(const DiagonalStats & other)
+{
+  for (size_t d = 0; d < size(); ++d)
+  {
+    main_sum_[d] += other.main_sum_[d];
+    anti_sum_[d] += other.anti_sum_[d];
+    main_zeros_[d] += other.main_zeros_[d];
+    anti_zeros_[d] += other.anti_zeros_[d];
+  }
+}
+
+void common::DiagonalStats::update(size_t row, size_t col, int from, int to)
+{
+  const size_t main = mainIndex(row, col);
+  const size_t anti = antiIndex(row, col);
+  const long long delta = static_cast< long long >(to) - from;
+  main_sum_[main] += delta;
+  anti_sum_[anti] += delta;
+  main_zeros_[main] = main_zeros_[main] + (to == 0) - (from == 0);
+  anti_zeros_[anti] = anti_zeros_[anti] + (to == 0) - (from == 0);
+}
+
+size_t common::DiagonalStats::size() const
+{
+  return main_sum_.size();
+}
+
+size_t common::DiagonalStats::mainIndex(size_t row, size_t col) const
+{
+  return rows_ - 1 - row + col;
+}
+
+size_t common::DiagonalStats::antiIndex(size_t row, size_t col) const
+{
+  return row + col;
+}
+
+long long common::DiagonalStats::mainSum(size_t d) const
+{
+  return main_sum_[d];
+}
+
+long long common::DiagonalStats::antiSum(size_t d) const
+{
+  return anti_sum_[d];
+}
+
+size_t common::DiagonalStats::mainZeros(size_t d) const
+{
+  return main_zeros_[d];
+}
+
+size_t common::DiagonalStats::antiZeros(size_t d) const
+{
+  return anti_zeros_[d];
+}
+
+size_t common::DiagonalStats::mainLength(size_t d) const
+{
+  const size_t first = d < rows_ - 1 ? rows_ - 1 - d : 0;
+  const size_t last = std::min(rows_ - 1, rows_ + cols_ - 2 - d);
+  return last - first + 1;
+}
+
+size_t common::DiagonalStats::antiLength(size_t d) const
+{
+  const size_t first = d < cols_ - 1 ? 0 : d - (cols_ - 1);
+  const size_t last = std::min(rows_ - 1, d);
+  return last - first + 1;
+}
+
+common::DiagonalStats common::scanDiagonals(const int * mtx, size_t rows, size_t cols)
+{
+  return scanDiagonals(MatrixView< const int >(mtx, rows, cols));
+}
+
+common::DiagonalStats common::scanDiagonals(const MatrixView< const int > & mtx)
+{
+  return scanAll(mtx);
+}
+
+common::DiagonalStats common::scanDiagonals(const MatrixView< const std::int16_t > & mtx)
+{
+  return scanAll(mtx);
+}
+
+common::DiagonalStats common::scanDiagonals(const MatrixView< const std::int8_t > & mtx)
+{
+  return scanAll(mtx);
+}
+
+template void common::DiagonalStats::addRows(const MatrixView< const int > &, size_t, size_t);
+template void common::DiagonalStats::addRows(const MatrixView< const std::int16_t > &, size_t, size_t);
+template void common::DiagonalStats::addRows(const MatrixView< const std::int8_t > &, size_t, size_t);
+template void common::DiagonalStats::addRow(size_t, const int *);
+template void common::DiagonalStats::addRow(size_t, const std::int16_t *);
+template void common::DiagonalStats::addRow(size_t, const std::int8_t *);
+template void common::DiagonalStats::operator()(size_t, const int *, const int *, const int *, size_t);
+template void common::DiagonalStats::operator()(size_t, const std::int16_t *, const std::int16_t *,
+    const std::int16_t *, size_t);
+template void common::DiagonalStats::operator()(size_t, const std::int8_t *, const std::int8_t *,
+    const std::int8_t *, size_t);
@@ -0,0 +1,50 @@
+#ifndef DIAGONALS_HPP
+#define DIAGONALS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <matrix_view.hpp>
+
+namespace common
+{
+  class DiagonalStats
+  {
+  public:
+    DiagonalStats(size_t rows, size_t cols);
+    static DiagonalStats zeros(size_t rows, size_t cols);
+    template< class T >
+    void addRows(const MatrixView< const T > & mtx, size_t begin, size_t end);
+    template< class T >
+    void addRow(size_t i, const T * row);
+    template< class T >
+    void operator()(size_t i, const T * above, const T * row, const T * below, size_t cols);
+    void merge(const DiagonalStats & other);
+    void update(size_t row, size_t col, int from, int to);
+
+    size_t size() const;
+    size_t mainIndex(size_t row, size_t col) const;
+    size_t antiIndex(size_t row, size_t col) const;
+    long long mainSum(size_t d) const;
+    long long antiSum(size_t d) const;
+    size_t mainZeros(size_t d) const;
+    size_t antiZeros(size_t d) const;
+    size_t mainLength(size_t d) const;
+    size_t antiLength(size_t d) const;
+
+  private:
+    size_t rows_;
+    size_t cols_;
+    std::vector< long long > main_sum_;
+    std::vector< long long > anti_sum_;
+    std::vector< size_t > main_zeros_;
+    std::vector< size_t > anti_zeros_;
+  };
+
+  DiagonalStats scanDiagonals(const int * mtx, size_t rows, size_t cols);
+  DiagonalStats scanDiagonals(const MatrixView< const int > & mtx);
+  DiagonalStats scanDiagonals(const MatrixView< const std::int16_t > & mtx);
+  DiagonalStats scanDiagonals(const MatrixView< const std::int8_t > & mtx);
+}
+
+#endif
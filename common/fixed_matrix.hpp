@@ -0,0 +1,93 @@
+#ifndef FIXED_MATRIX_HPP
+#define FIXED_MATRIX_HPP
+
+#include <cstddef>
+#include <utility>
+
+namespace common
+{
+  const size_t FIXED_SIDE = 16;
+
+  template< class T, size_t Rows, size_t Cols >
+  class FixedMatrix
+  {
+  public:
+    static constexpr size_t ROWS = Rows;
+    static constexpr size_t COLS = Cols;
+
+    T * data();
+    const T * data() const;
+    T * row(size_t i);
+    const T * row(size_t i) const;
+
+  private:
+    T data_[Rows * Cols];
+  };
+
+  template< class T, size_t Side, class Fn >
+  bool dispatchFixed(size_t rows, size_t cols, Fn fn);
+}
+
+namespace common
+{
+  namespace detail
+  {
+    template< class T, size_t Rows, size_t Cols, class Fn >
+    void callFixed(Fn & fn)
+    {
+      FixedMatrix< T, Rows, Cols > mtx;
+      fn(mtx);
+    }
+
+    template< class T, size_t Side, class Fn, size_t... I >
+    void callFixed(size_t rows, size_t cols, Fn & fn, std::index_sequence< I... >)
+    {
+      using Call = void (*)(Fn &);
+      static const Call calls[] = { &callFixed< T, I / Side + 1, I % Side + 1, Fn >... };
+      calls[(rows - 1) * Side + cols - 1](fn);
+    }
+  }
+}
+
+template< class T, size_t Rows, size_t Cols >
+constexpr size_t common::FixedMatrix< T, Rows, Cols >::ROWS;
+
+template< class T, size_t Rows, size_t Cols >
+constexpr size_t common::FixedMatrix< T, Rows, Cols >::COLS;
+
+template< class T, size_t Rows, size_t Cols >
+T * common::FixedMatrix< T, Rows, Cols >::data()
+{
+  return data_;
+}
+
+template< class T, size_t Rows, size_t Cols >
+const T * common::FixedMatrix< T, Rows, Cols >::data() const
+{
+  return data_;
+}
+
+template< class T, size_t Rows, size_t Cols >
+T * common::FixedMatrix< T, Rows, Cols >::row(size_t i)
+{
+  return data_ + i * Cols;
+}
+
+template< class T, size_t Rows, size_t Cols >
+const T * common::FixedMatrix< T, Rows, Cols >::row(size_t i) const
+{
+  return data_ + i * Cols;
+}
+
+template< class T, size_t Side, class Fn >
+bool common::dispatchFixed(size_t rows, size_t cols, Fn fn)
+{
+  if (rows == 0 || cols == 0 || rows > Side || cols > Side)
+  {
+    return false;
+  }
+  detail::callFixed< T, Side >(rows, cols, fn, std::make_index_sequence< Side * Side >());
+  return true;
+}
+
+#endif
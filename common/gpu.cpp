@@ -0,0 +1,420 @@
+#include <gpu.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+namespace
+{
+  using Handle = void *;
+  using Status = int;
+  using Notify = void (*)(const char *, const void *, size_t, void *);
+  using BuildNotify = void (*)(Handle, void *);
+
+  const Status SUCCESS = 0;
+  const unsigned long long DEVICE_TYPE_GPU = 1 << 2;
+  const unsigned long long MEM_WRITE_ONLY = 1 << 1;
+  const unsigned long long MEM_READ_ONLY = 1 << 2;
+  const unsigned BLOCKING = 1;
+  const unsigned NON_BLOCKING = 0;
+  const size_t GROUP_SIZE = 64;
+  const size_t DEFAULT_MIN_CELLS = 100000000;
+
+  const char * const KERNELS = R"(
+int beats(int center, int near, int minimum)
+{
+  return minimum ? center < near : center > near;
+}
+
+uint extremum(__global const int * mtx, ulong rows, ulong cols, ulong stride, ulong i, ulong j, int minimum,
+    int square)
+{
+  if (i == 0 || i + 1 >= rows || j == 0 || j + 1 >= cols)
+  {
+    return 0;
+  }
+  __global const int * up = mtx + (i - 1) * stride + j;
+  __global const int * row = mtx + i * stride + j;
+  __global const int * down = mtx + (i + 1) * stride + j;
+  const int center = row[0];
+  int hit = beats(center, up[0], minimum) && beats(center, row[-1], minimum) && beats(center, row[1], minimum)
+      && beats(center, down[0], minimum);
+  if (square)
+  {
+    hit = hit && beats(center, up[-1], minimum) && beats(center, up[1], minimum) && beats(center, down[-1], minimum)
+        && beats(center, down[1], minimum);
+  }
+  return hit ? 1 : 0;
+}
+
+__kernel void count_extrema(__global const int * mtx, ulong rows, ulong cols, ulong stride, int minimum, int square,
+    __global uint * counts, __local uint * scratch)
+{
+  const ulong cell = get_global_id(0);
+  const size_t local = get_local_id(0);
+  scratch[local] = cell < rows * cols ? extremum(mtx, rows, cols, stride, cell / cols, cell % cols, minimum, square) : 0;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  for (size_t half = get_local_size(0) / 2; half > 0; half /= 2)
+  {
+    if (local < half)
+    {
+      scratch[local] += scratch[local + half];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+  if (local == 0)
+  {
+    counts[get_group_id(0)] = scratch[0];
+  }
+}
+
+long window(__global const int * mtx, ulong rows, ulong cols, ulong stride, ulong i, ulong j)
+{
+  const ulong top = i > 0 ? i - 1 : i;
+  const ulong bottom = i + 1 < rows ? i + 1 : i;
+  const ulong left = j > 0 ? j - 1 : j;
+  const ulong right = j + 1 < cols ? j + 1 : j;
+  long sum = -(long) mtx[i * stride + j];
+  for (ulong r = top; r <= bottom; ++r)
+  {
+    for (ulong c = left; c <= right; ++c)
+    {
+      sum += mtx[r * stride + c];
+    }
+  }
+  return sum;
+}
+
+__kernel void window_sums(__global const int * mtx, ulong rows, ulong cols, ulong stride, ulong begin, ulong count,
+    __global long * sums)
+{
+  const ulong cell = get_global_id(0);
+  if (cell < count * cols)
+  {
+    sums[cell] = window(mtx, rows, cols, stride, begin + cell / cols, cell % cols);
+  }
+}
+)";
+
+  struct OpenCl
+  {
+    Status (*getPlatformIDs)(unsigned, Handle *, unsigned *);
+    Status (*getDeviceIDs)(Handle, unsigned long long, unsigned, Handle *, unsigned *);
+    Handle (*createContext)(const intptr_t *, unsigned, const Handle *, Notify, void *, Status *);
+    Handle (*createCommandQueue)(Handle, Handle, unsigned long long, Status *);
+    Handle (*createBuffer)(Handle, unsigned long long, size_t, void *, Status *);
+    Handle (*createProgramWithSource)(Handle, unsigned, const char **, const size_t *, Status *);
+    Status (*buildProgram)(Handle, unsigned, const Handle *, const char *, BuildNotify, void *);
+    Handle (*createKernel)(Handle, const char *, Status *);
+    Status (*setKernelArg)(Handle, unsigned, size_t, const void *);
+    Status (*enqueueWriteBuffer)(Handle, Handle, unsigned, size_t, size_t, const void *, unsigned, const Handle *,
+        Handle *);
+    Status (*enqueueReadBuffer)(Handle, Handle, unsigned, size_t, size_t, void *, unsigned, const Handle *, Handle *);
+    Status (*enqueueNDRangeKernel)(Handle, Handle, unsigned, const size_t *, const size_t *, const size_t *, unsigned,
+        const Handle *, Handle *);
+    Status (*finish)(Handle);
+    Status (*releaseMemObject)(Handle);
+  };
+
+#ifdef __linux__
+  template< class Fn >
+  bool bind(void * library, const char * name, Fn & fn)
+  {
+    fn = reinterpret_cast< Fn >(dlsym(library, name));
+    return fn != nullptr;
+  }
+
+  bool load(void * library, OpenCl & api)
+  {
+    return bind(library, "clGetPlatformIDs", api.getPlatformIDs)
+        && bind(library, "clGetDeviceIDs", api.getDeviceIDs)
+        && bind(library, "clCreateContext", api.createContext)
+        && bind(library, "clCreateCommandQueue", api.createCommandQueue)
+        && bind(library, "clCreateBuffer", api.createBuffer)
+        && bind(library, "clCreateProgramWithSource", api.createProgramWithSource)
+        && bind(library, "clBuildProgram", api.buildProgram)
+        && bind(library, "clCreateKernel", api.createKernel)
+        && bind(library, "clSetKernelArg", api.setKernelArg)
+        && bind(library, "clEnqueueWriteBuffer", api.enqueueWriteBuffer)
+        && bind(library, "clEnqueueReadBuffer", api.enqueueReadBuffer)
+        && bind(library, "clEnqueueNDRangeKernel", api.enqueueNDRangeKernel)
+        && bind(library, "clFinish", api.finish)
+        && bind(library, "clReleaseMemObject", api.releaseMemObject);
+  }
+
+  Handle firstGpu(const OpenCl & api)
+  {
+    unsigned platforms = 0;
+    if (api.getPlatformIDs(0, nullptr, &platforms) != SUCCESS || platforms == 0)
+    {
+      return nullptr;
+    }
+    std::vector< Handle > ids(platforms);
+    if (api.getPlatformIDs(platforms, ids.data(), nullptr) != SUCCESS)
+    {
+      return nullptr;
+    }
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      Handle gpu = nullptr;
+      unsigned count = 0;
+      if (api.getDeviceIDs(ids[i], DEVICE_TYPE_GPU, 1, &gpu, &count) == SUCCESS && count > 0)
+      {
+        return gpu;
+      }
+    }
+    return nullptr;
+  }
+#endif
+
+  class Device
+  {
+  public:
+    OpenCl api;
+    Handle context;
+    Handle queue;
+    Handle extrema;
+    Handle sums;
+    std::mutex mutex;
+
+    Device();
+    bool available() const;
+
+  private:
+    bool available_;
+  };
+
+  Device::Device():
+    api(),
+    context(nullptr),
+    queue(nullptr),
+    extrema(nullptr),
+    sums(nullptr),
+    mutex(),
+    available_(false)
+  {
+#ifdef __linux__
+    void * library = dlopen("libOpenCL.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!library || !load(library, api))
+    {
+      return;
+    }
+    Handle gpu = firstGpu(api);
+    if (!gpu)
+    {
+      return;
+    }
+    Status status = SUCCESS;
+    context = api.createContext(nullptr, 1, &gpu, nullptr, nullptr, &status);
+    if (status != SUCCESS)
+    {
+      return;
+    }
+    queue = api.createCommandQueue(context, gpu, 0, &status);
+    if (status != SUCCESS)
+    {
+      return;
+    }
+    const char * source = KERNELS;
+    Handle program = api.createProgramWithSource(context, 1, &source, nullptr, &status);
+    if (status != SUCCESS || api.buildProgram(program, 1, &gpu, "", nullptr, nullptr) != SUCCESS)
+    {
+      return;
+    }
+    extrema = api.createKernel(program, "count_extrema", &status);
+    if (status != SUCCESS)
+    {
+      return;
+    }
+    sums = api.createKernel(program, "window_sums", &status);
+    available_ = status == SUCCESS;
+#endif
+  }
+
+  bool Device::available() const
+  {
+    return available_;
+  }
+
+  Device & device()
+  {
+    // The context lives until exit: releasing it from a static destructor
+    // races with the teardown of the OpenCL loader itself.
+    static Device shared;
+    return shared;
+  }
+
+  template< class T >
+  bool setArg(Device & gpu, Handle kernel, unsigned index, const T & value)
+  {
+    return gpu.api.setKernelArg(kernel, index, sizeof(T), &value) == SUCCESS;
+  }
+
+  bool launch(Device & gpu, Handle kernel, size_t items)
+  {
+    const size_t local = GROUP_SIZE;
+    const size_t global = (items + GROUP_SIZE - 1) / GROUP_SIZE * GROUP_SIZE;
+    return gpu.api.enqueueNDRangeKernel(gpu.queue, kernel, 1, nullptr, &global, &local, 0, nullptr, nullptr) == SUCCESS;
+  }
+}
+
+size_t common::gpuMinCells()
+{
+  const char * value = std::getenv("MATRIX_GPU_CELLS");
+  if (value && *value)
+  {
+    return static_cast< size_t >(std::strtoull(value, nullptr, 10));
+  }
+  return DEFAULT_MIN_CELLS;
+}
+
+bool common::gpuOffload(size_t cells)
+{
+  const size_t least = gpuMinCells();
+  return least > 0 && cells >= least && device().available();
+}
+
+common::GpuMatrix::GpuMatrix():
+  buffer_(nullptr),
+  rows_(0),
+  cols_(0),
+  stride_(0),
+  valid_(false)
+{}
+
+common::GpuMatrix::~GpuMatrix()
+{
+  release();
+}
+
+void common::GpuMatrix::release()
+{
+  if (buffer_)
+  {
+    Device & gpu = device();
+    std::lock_guard< std::mutex > lock(gpu.mutex);
+    gpu.api.finish(gpu.queue);
+    gpu.api.releaseMemObject(buffer_);
+  }
+  buffer_ = nullptr;
+  valid_ = false;
+}
+
+bool common::GpuMatrix::allocate(size_t rows, size_t cols, size_t stride)
+{
+  release();
+  Device & gpu = device();
+  if (!gpu.available() || rows == 0 || cols == 0)
+  {
+    return false;
+  }
+  std::lock_guard< std::mutex > lock(gpu.mutex);
+  Status status = SUCCESS;
+  buffer_ = gpu.api.createBuffer(gpu.context, MEM_READ_ONLY, ((rows - 1) * stride + cols) * sizeof(int), nullptr,
+      &status);
+  if (status != SUCCESS)
+  {
+    buffer_ = nullptr;
+    return false;
+  }
+  rows_ = rows;
+  cols_ = cols;
+  stride_ = stride;
+  valid_ = true;
+  return true;
+}
+
+bool common::GpuMatrix::valid() const
+{
+  return valid_;
+}
+
+bool common::GpuMatrix::upload(size_t offset, const int * values, size_t count)
+{
+  if (!valid_)
+  {
+    return false;
+  }
+  Device & gpu = device();
+  std::lock_guard< std::mutex > lock(gpu.mutex);
+  valid_ = gpu.api.enqueueWriteBuffer(gpu.queue, buffer_, NON_BLOCKING, offset * sizeof(int), count * sizeof(int),
+      values, 0, nullptr, nullptr) == SUCCESS;
+  return valid_;
+}
+
+bool common::GpuMatrix::countExtrema(bool minimum, bool square, size_t & count)
+{
+  if (!valid_)
+  {
+    return false;
+  }
+  Device & gpu = device();
+  const size_t cells = rows_ * cols_;
+  const size_t groups = (cells + GROUP_SIZE - 1) / GROUP_SIZE;
+  std::vector< unsigned > counts(groups, 0);
+  std::lock_guard< std::mutex > lock(gpu.mutex);
+  Status status = SUCCESS;
+  Handle partial = gpu.api.createBuffer(gpu.context, MEM_WRITE_ONLY, groups * sizeof(unsigned), nullptr, &status);
+  if (status != SUCCESS)
+  {
+    return false;
+  }
+  const unsigned long long rows = rows_;
+  const unsigned long long cols = cols_;
+  const unsigned long long stride = stride_;
+  const int lower = minimum ? 1 : 0;
+  const int corners = square ? 1 : 0;
+  const bool done = setArg(gpu, gpu.extrema, 0, buffer_) && setArg(gpu, gpu.extrema, 1, rows)
+      && setArg(gpu, gpu.extrema, 2, cols) && setArg(gpu, gpu.extrema, 3, stride)
+      && setArg(gpu, gpu.extrema, 4, lower) && setArg(gpu, gpu.extrema, 5, corners)
+      && setArg(gpu, gpu.extrema, 6, partial)
+      && gpu.api.setKernelArg(gpu.extrema, 7, GROUP_SIZE * sizeof(unsigned), nullptr) == SUCCESS
+      && launch(gpu, gpu.extrema, cells)
+      && gpu.api.enqueueReadBuffer(gpu.queue, partial, BLOCKING, 0, groups * sizeof(unsigned), counts.data(), 0,
+          nullptr, nullptr) == SUCCESS;
+  gpu.api.releaseMemObject(partial);
+  if (!done)
+  {
+    return false;
+  }
+  count = 0;
+  for (size_t i = 0; i < groups; ++i)
+  {
+    count += counts[i];
+  }
+  return true;
+}
+
+bool common::GpuMatrix::windowSums(size_t begin, size_t end, long long * sums)
+{
+  if (!valid_ || begin >= end || end > rows_)
+  {
+    return false;
+  }
+  Device & gpu = device();
+  const size_t cells = (end - begin) * cols_;
+  std::lock_guard< std::mutex > lock(gpu.mutex);
+  Status status = SUCCESS;
+  Handle result = gpu.api.createBuffer(gpu.context, MEM_WRITE_ONLY, cells * sizeof(long long), nullptr, &status);
+  if (status != SUCCESS)
+  {
+    return false;
+  }
+  const unsigned long long rows = rows_;
+  const unsigned long long cols = cols_;
+  const unsigned long long stride = stride_;
+  const unsigned long long first = begin;
+  const unsigned long long count = end - begin;
+  const bool done = setArg(gpu, gpu.sums, 0, buffer_) && setArg(gpu, gpu.sums, 1, rows)
+      && setArg(gpu, gpu.sums, 2, cols) && setArg(gpu, gpu.sums, 3, stride)
+      && setArg(gpu, gpu.sums, 4, first) && setArg(gpu, gpu.sums, 5, count)
+      && setArg(gpu, gpu.sums, 6, result)
+      && launch(gpu, gpu.sums, cells)
+      && gpu.api.enqueueReadBuffer(gpu.queue, result, BLOCKING, 0, cells * sizeof(long long), sums, 0, nullptr,
+          nullptr) == SUCCESS;
+  gpu.api.releaseMemObject(result);
+  return done;
+}
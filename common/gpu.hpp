@@ -0,0 +1,36 @@
+#ifndef GPU_HPP
+#define GPU_HPP
+
+#include <cstddef>
+
+namespace common
+{
+  size_t gpuMinCells();
+  bool gpuOffload(size_t cells);
+
+  class GpuMatrix
+  {
+  public:
+    GpuMatrix();
+    ~GpuMatrix();
+    GpuMatrix(const GpuMatrix &) = delete;
+    GpuMatrix & operator=(const GpuMatrix &) = delete;
+
+    bool allocate(size_t rows, size_t cols, size_t stride);
+    bool valid() const;
+    bool upload(size_t offset, const int * values, size_t count);
+    bool countExtrema(bool minimum, bool square, size_t & count);
+    bool windowSums(size_t begin, size_t end, long long * sums);
+
+  private:
+    void * buffer_;
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+    bool valid_;
+
+    void release();
+  };
+}
+
+#endif
@@ -0,0 +1,247 @@
+#include <incremental.hpp>
+#include <algorithm>
+#include <limits>
+#include <neighbourhood.hpp>
+
+common::IncrementalAnalysis::IncrementalAnalysis(const MatrixView< const int > & mtx):
+  rows_(mtx.rows()),
+  cols_(mtx.cols()),
+  values_(rows_ * cols_),
+  flags_(rows_ * cols_, 0),
+  counts_(),
+  row_min_(rows_),
+  col_max_(cols_),
+  diagonals_(scanDiagonals(mtx)),
+  anti_sums_(),
+  side_(std::min(rows_, cols_)),
+  offset_sums_(side_ / 2 * 2, 0),
+  offset_maxima_()
+{
+  for (size_t i = 0; i < rows_; ++i)
+  {
+    std::copy(mtx.row(i), mtx.row(i) + cols_, values_.data() + i * cols_);
+  }
+  for (size_t i = 0; i < rows_; ++i)
+  {
+    const int * row = values_.data() + i * cols_;
+    row_min_[i] = *std::min_element(row, row + cols_);
+    for (size_t j = 0; j < cols_; ++j)
+    {
+      col_max_[j] = i == 0 ? row[j] : std::max(col_max_[j], row[j]);
+    }
+  }
+  for (size_t i = 0; i < rows_; ++i)
+  {
+    for (size_t j = 0; j < cols_; ++j)
+    {
+      setFlags(i, j, extremaFlags(i, j) | (isSaddle(i, j) << saddle), 0xFF);
+    }
+  }
+  for (size_t d = 0; d < diagonals_.size(); ++d)
+  {
+    anti_sums_.insert(diagonals_.antiSum(d));
+  }
+  for (size_t i = 0; i < side_; ++i)
+  {
+    for (size_t j = 0; j < side_; ++j)
+    {
+      const size_t offset = offsetIndex(i, j);
+      if (offset < offset_sums_.size())
+      {
+        offset_sums_[offset] += at(i, j);
+      }
+    }
+  }
+  offset_maxima_.insert(offset_sums_.begin(), offset_sums_.end());
+}
+
+size_t common::IncrementalAnalysis::rows() const
+{
+  return rows_;
+}
+
+size_t common::IncrementalAnalysis::cols() const
+{
+  return cols_;
+}
+
+int common::IncrementalAnalysis::at(size_t row, size_t col) const
+{
+  return values_[row * cols_ + col];
+}
+
+void common::IncrementalAnalysis::update(size_t row, size_t col, int value)
+{
+  const int from = at(row, col);
+  if (from == value)
+  {
+    return;
+  }
+  values_[row * cols_ + col] = value;
+  updateDiagonals(row, col, from, value);
+  updateExtrema(row, col);
+  const bool row_changed = updateRowMin(row, from, value);
+  const bool col_changed = updateColMax(col, from, value);
+  const unsigned char mask = 1 << saddle;
+  if (row_changed)
+  {
+    for (size_t j = 0; j < cols_; ++j)
+    {
+      setFlags(row, j, isSaddle(row, j) << saddle, mask);
+    }
+  }
+  if (col_changed)
+  {
+    for (size_t i = 0; i < rows_; ++i)
+    {
+      setFlags(i, col, isSaddle(i, col) << saddle, mask);
+    }
+  }
+  setFlags(row, col, isSaddle(row, col) << saddle, mask);
+}
+
+size_t common::IncrementalAnalysis::crossMaxima() const
+{
+  return counts_[cross_max];
+}
+
+size_t common::IncrementalAnalysis::squareMaxima() const
+{
+  return counts_[square_max];
+}
+
+size_t common::IncrementalAnalysis::squareMinima() const
+{
+  return counts_[square_min];
+}
+
+size_t common::IncrementalAnalysis::saddlePoints() const
+{
+  return counts_[saddle];
+}
+
+const common::DiagonalStats & common::IncrementalAnalysis::diagonals() const
+{
+  return diagonals_;
+}
+
+long long common::IncrementalAnalysis::minAntiSum() const
+{
+  return anti_sums_.empty() ? 0 : *anti_sums_.begin();
+}
+
+long long common::IncrementalAnalysis::maxOffsetSum() const
+{
+  return offset_maxima_.empty() ? std::numeric_limits< int >::min() : *offset_maxima_.rbegin();
+}
+
+unsigned char common::IncrementalAnalysis::extremaFlags(size_t row, size_t col) const
+{
+  if (row == 0 || col == 0 || row + 1 >= rows_ || col + 1 >= cols_)
+  {
+    return 0;
+  }
+  const int * above = values_.data() + (row - 1) * cols_ + col - 1;
+  const int * middle = above + cols_;
+  const int * below = middle + cols_;
+  unsigned char flags = 0;
+  flags |= countExtremaRow< StrictMax, CrossShape >(above, middle, below, 3) << cross_max;
+  flags |= countExtremaRow< StrictMax, SquareShape >(above, middle, below, 3) << square_max;
+  flags |= countExtremaRow< StrictMin, SquareShape >(above, middle, below, 3) << square_min;
+  return flags;
+}
+
+bool common::IncrementalAnalysis::isSaddle(size_t row, size_t col) const
+{
+  const int value = at(row, col);
+  return value == row_min_[row] && value == col_max_[col];
+}
+
+void common::IncrementalAnalysis::setFlags(size_t row, size_t col, unsigned char flags, unsigned char mask)
+{
+  unsigned char & cell = flags_[row * cols_ + col];
+  const unsigned char changed = (cell ^ flags) & mask;
+  for (size_t f = 0; f < flag_count; ++f)
+  {
+    if ((changed >> f) & 1)
+    {
+      (flags >> f) & 1 ? ++counts_[f] : --counts_[f];
+    }
+  }
+  cell = (cell & ~mask) | (flags & mask);
+}
+
+void common::IncrementalAnalysis::updateExtrema(size_t row, size_t col)
+{
+  const unsigned char mask = (1 << cross_max) | (1 << square_max) | (1 << square_min);
+  const size_t first_row = row > 0 ? row - 1 : 0;
+  const size_t first_col = col > 0 ? col - 1 : 0;
+  for (size_t i = first_row; i <= row + 1 && i < rows_; ++i)
+  {
+    for (size_t j = first_col; j <= col + 1 && j < cols_; ++j)
+    {
+      setFlags(i, j, extremaFlags(i, j), mask);
+    }
+  }
+}
+
+bool common::IncrementalAnalysis::updateRowMin(size_t row, int from, int to)
+{
+  int & current = row_min_[row];
+  const int previous = current;
+  if (to < current)
+  {
+    current = to;
+  }
+  else if (from == current)
+  {
+    const int * values = values_.data() + row * cols_;
+    current = *std::min_element(values, values + cols_);
+  }
+  return current != previous;
+}
+
+bool common::IncrementalAnalysis::updateColMax(size_t col, int from, int to)
+{
+  int & current = col_max_[col];
+  const int previous = current;
+  if (to > current)
+  {
+    current = to;
+  }
+  else if (from == current)
+  {
+    current = values_[col];
+    for (size_t i = 1; i < rows_; ++i)
+    {
+      current = std::max(current, values_[i * cols_ + col]);
+    }
+  }
+  return current != previous;
+}
+
+size_t common::IncrementalAnalysis::offsetIndex(size_t row, size_t col) const
+{
+  const size_t half = side_ / 2;
+  const size_t offset = row < col ? col - row : row - col;
+  if (row >= side_ || col >= side_ || offset == 0 || offset > half)
+  {
+    return offset_sums_.size();
+  }
+  return (row < col ? 0 : half) + offset - 1;
+}
+
+void common::IncrementalAnalysis::updateDiagonals(size_t row, size_t col, int from, int to)
+{
+  const size_t anti = diagonals_.antiIndex(row, col);
+  anti_sums_.erase(anti_sums_.find(diagonals_.antiSum(anti)));
+  diagonals_.update(row, col, from, to);
+  anti_sums_.insert(diagonals_.antiSum(anti));
+  const size_t offset = offsetIndex(row, col);
+  if (offset < offset_sums_.size())
+  {
+    offset_maxima_.erase(offset_maxima_.find(offset_sums_[offset]));
+    offset_sums_[offset] += static_cast< long long >(to) - from;
+    offset_maxima_.insert(offset_sums_[offset]);
+  }
+}
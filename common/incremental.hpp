@@ -0,0 +1,64 @@
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include <cstddef>
+#include <set>
+#include <vector>
+#include <diagonals.hpp>
+#include <matrix_view.hpp>
+
+namespace common
+{
+  class IncrementalAnalysis
+  {
+  public:
+    explicit IncrementalAnalysis(const MatrixView< const int > & mtx);
+
+    size_t rows() const;
+    size_t cols() const;
+    int at(size_t row, size_t col) const;
+    void update(size_t row, size_t col, int value);
+
+    size_t crossMaxima() const;
+    size_t squareMaxima() const;
+    size_t squareMinima() const;
+    size_t saddlePoints() const;
+    const DiagonalStats & diagonals() const;
+    long long minAntiSum() const;
+    long long maxOffsetSum() const;
+
+  private:
+    enum Flag
+    {
+      cross_max,
+      square_max,
+      square_min,
+      saddle,
+      flag_count
+    };
+
+    size_t rows_;
+    size_t cols_;
+    std::vector< int > values_;
+    std::vector< unsigned char > flags_;
+    size_t counts_[flag_count];
+    std::vector< int > row_min_;
+    std::vector< int > col_max_;
+    DiagonalStats diagonals_;
+    std::multiset< long long > anti_sums_;
+    size_t side_;
+    std::vector< long long > offset_sums_;
+    std::multiset< long long > offset_maxima_;
+
+    unsigned char extremaFlags(size_t row, size_t col) const;
+    bool isSaddle(size_t row, size_t col) const;
+    void setFlags(size_t row, size_t col, unsigned char flags, unsigned char mask);
+    void updateExtrema(size_t row, size_t col);
+    bool updateRowMin(size_t row, int from, int to);
+    bool updateColMax(size_t col, int from, int to);
+    size_t offsetIndex(size_t row, size_t col) const;
+    void updateDiagonals(size_t row, size_t col, int from, int to);
+  };
+}
+
+#endif
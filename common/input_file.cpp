@@ -0,0 +1,120 @@
+#include <input_file.hpp>
+
+common::MemoryBuf::MemoryBuf()
+{}
+
+common::MemoryBuf::MemoryBuf(const char * begin, const char * end)
+{
+  reset(begin, end);
+}
+
+void common::MemoryBuf::reset(const char * begin, const char * end)
+{
+  char * first = const_cast< char * >(begin);
+  setg(first, first, const_cast< char * >(end));
+}
+
+const char * common::MemoryBuf::current() const
+{
+  return gptr();
+}
+
+const char * common::MemoryBuf::end() const
+{
+  return egptr();
+}
+
+void common::MemoryBuf::advance(const char * pos)
+{
+  setg(eback(), const_cast< char * >(pos), egptr());
+}
+
+std::streambuf::pos_type common::MemoryBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+  if (!(which & std::ios_base::in))
+  {
+    return pos_type(off_type(-1));
+  }
+  off_type base = 0;
+  if (dir == std::ios_base::cur)
+  {
+    base = gptr() - eback();
+  }
+  else if (dir == std::ios_base::end)
+  {
+    base = egptr() - eback();
+  }
+  off_type target = base + off;
+  if (target < 0 || target > egptr() - eback())
+  {
+    return pos_type(off_type(-1));
+  }
+  setg(eback(), eback() + target, egptr());
+  return pos_type(target);
+}
+
+std::streambuf::pos_type common::MemoryBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+common::InputFile::InputFile(const char * path, bool mapped):
+  std::istream(nullptr),
+  mapped_(mapped)
+{
+  if (mapped_ && mapping_.open(path))
+  {
+    memory_.reset(mapping_.data(), mapping_.data() + mapping_.size());
+    rdbuf(&memory_);
+  }
+  else if (!mapped_ && file_.open(path, std::ios_base::in))
+  {
+    rdbuf(&file_);
+  }
+  else
+  {
+    rdbuf(&file_);
+    setstate(std::ios_base::failbit);
+  }
+}
+
+bool common::InputFile::is_open() const
+{
+  return mapped_ ? mapping_.is_open() : file_.is_open();
+}
+
+void common::InputFile::close()
+{
+  if (mapped_)
+  {
+    memory_.reset(nullptr, nullptr);
+  }
+  else if (!file_.close())
+  {
+    setstate(std::ios_base::failbit);
+  }
+}
+
+template< class T >
+bool common::InputFile::mappedMatrix(ElementType type, T *& data, size_t & rows, size_t & cols)
+{
+  BinaryHeader header = {};
+  if (!mapped_ || !parseBinaryHeader(mapping_.data(), mapping_.size(), header) || header.type != type)
+  {
+    return false;
+  }
+  data = reinterpret_cast< T * >(mapping_.data() + sizeof(BinaryHeader));
+  rows = header.rows;
+  cols = header.cols;
+  return true;
+}
+
+bool common::InputFile::binaryMatrix(int *& data, size_t & rows, size_t & cols)
+{
+  return mappedMatrix(ElementType::int32, data, rows, cols);
+}
+
+bool common::InputFile::binaryMatrix(long long *& data, size_t & rows, size_t & cols)
+{
+  return mappedMatrix(ElementType::int64, data, rows, cols);
+}
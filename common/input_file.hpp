@@ -0,0 +1,51 @@
+#ifndef INPUT_FILE_HPP
+#define INPUT_FILE_HPP
+
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <mapped_file.hpp>
+#include <matrix_binary.hpp>
+
+namespace common
+{
+  class MemoryBuf: public std::streambuf
+  {
+  public:
+    MemoryBuf();
+    MemoryBuf(const char * begin, const char * end);
+
+    void reset(const char * begin, const char * end);
+    const char * current() const;
+    const char * end() const;
+    void advance(const char * pos);
+
+  protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+  };
+
+  class InputFile: public std::istream
+  {
+  public:
+    InputFile(const char * path, bool mapped);
+    InputFile(const InputFile &) = delete;
+    InputFile & operator=(const InputFile &) = delete;
+
+    bool is_open() const;
+    void close();
+    bool binaryMatrix(int *& data, size_t & rows, size_t & cols);
+    bool binaryMatrix(long long *& data, size_t & rows, size_t & cols);
+
+  private:
+    template< class T >
+    bool mappedMatrix(ElementType type, T *& data, size_t & rows, size_t & cols);
+
+    std::filebuf file_;
+    MappedFile mapping_;
+    MemoryBuf memory_;
+    bool mapped_;
+  };
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include <mapped_file.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+common::MappedFile::MappedFile():
+  data_(nullptr),
+  size_(0),
+  open_(false)
+{}
+
+common::MappedFile::MappedFile(const char * path):
+  MappedFile()
+{
+  open(path);
+}
+
+common::MappedFile::~MappedFile()
+{
+  close();
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+bool common::MappedFile::open(const char * path)
+{
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+  struct stat info = {};
+  if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+  {
+    ::close(fd);
+    return false;
+  }
+  size_t size = static_cast< size_t >(info.st_size);
+  if (size != 0)
+  {
+    void * addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+      ::close(fd);
+      return false;
+    }
+    ::madvise(addr, size, MADV_SEQUENTIAL);
+    data_ = static_cast< char * >(addr);
+  }
+  ::close(fd);
+  size_ = size;
+  open_ = true;
+  return true;
+}
+
+void common::MappedFile::close()
+{
+  if (data_)
+  {
+    ::munmap(data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  open_ = false;
+}
+#else
+bool common::MappedFile::open(const char * path)
+{
+  close();
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+  {
+    return false;
+  }
+  size_t size = static_cast< size_t >(file.tellg());
+  file.seekg(0);
+  if (size != 0)
+  {
+    data_ = new char[size];
+    if (!file.read(data_, size))
+    {
+      close();
+      return false;
+    }
+  }
+  size_ = size;
+  open_ = true;
+  return true;
+}
+
+void common::MappedFile::close()
+{
+  delete[] data_;
+  data_ = nullptr;
+  size_ = 0;
+  open_ = false;
+}
+#endif
+
+bool common::MappedFile::is_open() const
+{
+  return open_;
+}
+
+char * common::MappedFile::data()
+{
+  return data_;
+}
+
+const char * common::MappedFile::data() const
+{
+  return data_;
+}
+
+size_t common::MappedFile::size() const
+{
+  return size_;
+}
@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+
+namespace common
+{
+  class MappedFile
+  {
+  public:
+    MappedFile();
+    explicit MappedFile(const char * path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool open(const char * path);
+    void close();
+    bool is_open() const;
+    char * data();
+    const char * data() const;
+    size_t size() const;
+
+  private:
+    char * data_;
+    size_t size_;
+    bool open_;
+  };
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include <matrix_binary.hpp>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  const char MAGIC[4] = { 'M', 'T', 'X', 'B' };
+  const std::uint32_t VERSION = 1;
+
+  static_assert(sizeof(common::BinaryHeader) == 32, "binary header layout");
+  static_assert(sizeof(int) == 4 && sizeof(long long) == 8, "element sizes");
+
+  std::ostream & writeBinary(std::ostream & out, common::ElementType type, const void * data, size_t rows, size_t cols)
+  {
+    common::BinaryHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.type = type;
+    header.rows = rows;
+    header.cols = cols;
+    out.write(reinterpret_cast< const char * >(&header), sizeof(header));
+    size_t bytes = rows * cols * common::elementSize(type);
+    return out.write(static_cast< const char * >(data), bytes);
+  }
+}
+
+size_t common::elementSize(ElementType type)
+{
+  switch (type)
+  {
+  case ElementType::int32:
+    return 4;
+  case ElementType::int64:
+    return 8;
+  }
+  return 0;
+}
+
+bool common::parseBinaryHeader(const char * data, size_t size, BinaryHeader & header)
+{
+  if (size < sizeof(BinaryHeader) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(BinaryHeader));
+  size_t width = elementSize(header.type);
+  if (header.version != VERSION || width == 0)
+  {
+    return false;
+  }
+  const std::uint64_t limit = std::numeric_limits< size_t >::max() / width;
+  if (header.cols != 0 && header.rows > limit / header.cols)
+  {
+    return false;
+  }
+  return header.rows * header.cols * width <= size - sizeof(BinaryHeader);
+}
+
+std::ostream & common::writeBinaryMatrix(std::ostream & out, const int * mtx, size_t rows, size_t cols)
+{
+  return writeBinary(out, ElementType::int32, mtx, rows, cols);
+}
+
+std::ostream & common::writeBinaryMatrix(std::ostream & out, const long long * mtx, size_t rows, size_t cols)
+{
+  return writeBinary(out, ElementType::int64, mtx, rows, cols);
+}
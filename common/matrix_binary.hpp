@@ -0,0 +1,32 @@
+#ifndef MATRIX_BINARY_HPP
+#define MATRIX_BINARY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace common
+{
+  enum class ElementType: std::uint32_t
+  {
+    int32 = 1,
+    int64 = 2
+  };
+
+  struct BinaryHeader
+  {
+    char magic[4];
+    std::uint32_t version;
+    ElementType type;
+    std::uint32_t reserved;
+    std::uint64_t rows;
+    std::uint64_t cols;
+  };
+
+  bool parseBinaryHeader(const char * data, size_t size, BinaryHeader & header);
+  size_t elementSize(ElementType type);
+  std::ostream & writeBinaryMatrix(std::ostream & out, const int * mtx, size_t rows, size_t cols);
+  std::ostream & writeBinaryMatrix(std::ostream & out, const long long * mtx, size_t rows, size_t cols);
+}
+
+#endif
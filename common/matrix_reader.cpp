@@ -0,0 +1,327 @@
+#include <matrix_reader.hpp>
+#include <limits>
+#include <input_file.hpp>
+#include <numa.hpp>
+#include <phase.hpp>
+
+namespace
+{
+  bool isSpace(char c)
+  {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+
+  template< class T >
+  T negate(unsigned long long magnitude)
+  {
+    if (magnitude == 0)
+    {
+      return 0;
+    }
+    return static_cast< T >(-static_cast< long long >(magnitude - 1) - 1);
+  }
+
+  template< class T >
+  size_t readFromStream(std::istream & input, T * values, size_t count)
+  {
+    if (count == 0)
+    {
+      return 0;
+    }
+    common::Phase phase("read", count);
+    common::StreamReader reader(input);
+    const size_t done = reader.read(values, count);
+    phase.addBytes(reader.consumed());
+    return done;
+  }
+
+  template< class T >
+  size_t readPadded(std::istream & input, common::PaddedMatrix< T > & mtx)
+  {
+    if (mtx.rows() == 0 || mtx.cols() == 0)
+    {
+      return 0;
+    }
+    common::Phase phase("read", mtx.rows() * mtx.cols());
+    common::StreamReader reader(input);
+    size_t done = 0;
+    for (size_t i = 0; i < mtx.rows(); ++i)
+    {
+      const size_t got = reader.read(mtx.row(i), mtx.cols());
+      done += got;
+      if (got != mtx.cols())
+      {
+        break;
+      }
+    }
+    phase.addBytes(reader.consumed());
+    return done;
+  }
+}
+
+common::IntScanner::IntScanner(const char * begin, const char * end):
+  pos_(begin),
+  end_(end),
+  start_(begin),
+  done_(0),
+  source_(nullptr),
+  memory_(nullptr),
+  buffer_(nullptr),
+  eof_(false),
+  fail_(false)
+{}
+
+common::IntScanner::IntScanner(std::streambuf * source):
+  pos_(nullptr),
+  end_(nullptr),
+  start_(nullptr),
+  done_(0),
+  source_(source),
+  memory_(dynamic_cast< MemoryBuf * >(source)),
+  buffer_(nullptr),
+  eof_(false),
+  fail_(false)
+{
+  if (memory_)
+  {
+    pos_ = memory_->current();
+    end_ = memory_->end();
+    start_ = pos_;
+    source_ = nullptr;
+  }
+  else
+  {
+    buffer_ = new char[CHUNK_SIZE];
+  }
+}
+
+common::IntScanner::~IntScanner()
+{
+  if (memory_)
+  {
+    memory_->advance(pos_);
+  }
+  else if (source_ && pos_ != end_)
+  {
+    source_->pubseekoff(pos_ - end_, std::ios_base::cur, std::ios_base::in);
+  }
+  delete[] buffer_;
+}
+
+bool common::IntScanner::eof() const
+{
+  return eof_;
+}
+
+bool common::IntScanner::fail() const
+{
+  return fail_;
+}
+
+const char * common::IntScanner::position() const
+{
+  return pos_;
+}
+
+size_t common::IntScanner::consumed() const
+{
+  return done_ + (pos_ - start_);
+}
+
+bool common::IntScanner::refill()
+{
+  if (!source_ || eof_)
+  {
+    eof_ = true;
+    return false;
+  }
+  std::streamsize got = source_->sgetn(buffer_, CHUNK_SIZE);
+  done_ += pos_ - start_;
+  start_ = buffer_;
+  pos_ = buffer_;
+  end_ = buffer_ + (got > 0 ? got : 0);
+  eof_ = got <= 0;
+  return !eof_;
+}
+
+bool common::IntScanner::skipSpaces()
+{
+  while (true)
+  {
+    while (pos_ != end_ && isSpace(*pos_))
+    {
+      ++pos_;
+    }
+    if (pos_ != end_)
+    {
+      return true;
+    }
+    if (!refill())
+    {
+      return false;
+    }
+  }
+}
+
+bool common::IntScanner::scanDigits(unsigned long long limit, unsigned long long & result, bool & overflow)
+{
+  bool digits = false;
+  while (pos_ != end_ || refill())
+  {
+    const unsigned digit = static_cast< unsigned char >(*pos_) - '0';
+    if (digit > 9)
+    {
+      break;
+    }
+    if (result > (limit - digit) / 10)
+    {
+      overflow = true;
+    }
+    else
+    {
+      result = result * 10 + digit;
+    }
+    digits = true;
+    ++pos_;
+  }
+  return digits;
+}
+
+template< class T >
+bool common::IntScanner::nextSigned(T & value)
+{
+  if (fail_ || !skipSpaces())
+  {
+    fail_ = true;
+    return false;
+  }
+  bool negative = *pos_ == '-';
+  if (negative || *pos_ == '+')
+  {
+    ++pos_;
+  }
+  const unsigned long long max = std::numeric_limits< T >::max();
+  unsigned long long result = 0;
+  bool overflow = false;
+  if (!scanDigits(negative ? max + 1 : max, result, overflow))
+  {
+    value = 0;
+    fail_ = true;
+    return false;
+  }
+  if (overflow)
+  {
+    value = negative ? std::numeric_limits< T >::min() : std::numeric_limits< T >::max();
+    fail_ = true;
+    return false;
+  }
+  value = negative ? negate< T >(result) : static_cast< T >(result);
+  return true;
+}
+
+bool common::IntScanner::next(int & value)
+{
+  return nextSigned(value);
+}
+
+bool common::IntScanner::next(long long & value)
+{
+  return nextSigned(value);
+}
+
+bool common::IntScanner::next(size_t & value)
+{
+  if (fail_ || !skipSpaces())
+  {
+    fail_ = true;
+    return false;
+  }
+  bool negative = *pos_ == '-';
+  if (negative || *pos_ == '+')
+  {
+    ++pos_;
+  }
+  const unsigned long long limit = std::numeric_limits< size_t >::max();
+  unsigned long long result = 0;
+  bool overflow = false;
+  const bool digits = scanDigits(limit, result, overflow);
+  if (!digits || overflow)
+  {
+    value = digits ? limit : 0;
+    fail_ = true;
+    return false;
+  }
+  value = negative ? 0 - result : result;
+  return true;
+}
+
+common::StreamReader::StreamReader(std::istream & input):
+  input_(input),
+  good_(input.good() && input.rdbuf()),
+  scanner_(good_ ? input.rdbuf() : nullptr)
+{}
+
+common::StreamReader::~StreamReader()
+{
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  if (scanner_.eof())
+  {
+    state |= std::ios_base::eofbit;
+  }
+  if (!good_ || scanner_.fail())
+  {
+    state |= std::ios_base::failbit;
+  }
+  input_.setstate(state);
+}
+
+size_t common::StreamReader::read(int * values, size_t count)
+{
+  return good_ ? scanner_.read(values, count) : 0;
+}
+
+size_t common::StreamReader::read(long long * values, size_t count)
+{
+  return good_ ? scanner_.read(values, count) : 0;
+}
+
+size_t common::StreamReader::consumed() const
+{
+  return scanner_.consumed();
+}
+
+size_t common::readIntegers(std::istream & input, int * values, size_t count)
+{
+  return readFromStream(input, values, count);
+}
+
+size_t common::readIntegers(std::istream & input, long long * values, size_t count)
+{
+  return readFromStream(input, values, count);
+}
+
+std::istream & common::readMatrix(std::istream & input, int * mtx, size_t rows, size_t cols)
+{
+  placeRows(mtx, rows, cols, cols * sizeof(int));
+  readIntegers(input, mtx, rows * cols);
+  return input;
+}
+
+std::istream & common::readMatrix(std::istream & input, long long * mtx, size_t rows, size_t cols)
+{
+  placeRows(mtx, rows, cols, cols * sizeof(long long));
+  readIntegers(input, mtx, rows * cols);
+  return input;
+}
+
+size_t common::readIntegers(std::istream & input, PaddedMatrix< int > & mtx)
+{
+  placeRows(mtx.row(0), mtx.rows(), mtx.cols(), mtx.stride() * sizeof(int));
+  return readPadded(input, mtx);
+}
+
+size_t common::readIntegers(std::istream & input, PaddedMatrix< long long > & mtx)
+{
+  placeRows(mtx.row(0), mtx.rows(), mtx.cols(), mtx.stride() * sizeof(long long));
+  return readPadded(input, mtx);
+}
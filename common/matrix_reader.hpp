@@ -0,0 +1,91 @@
+#ifndef MATRIX_READER_HPP
+#define MATRIX_READER_HPP
+
+#include <cstddef>
+#include <istream>
+#include <streambuf>
+#include <padded_matrix.hpp>
+
+namespace common
+{
+  class MemoryBuf;
+
+  class IntScanner
+  {
+  public:
+    IntScanner(const char * begin, const char * end);
+    explicit IntScanner(std::streambuf * source);
+    ~IntScanner();
+    IntScanner(const IntScanner &) = delete;
+    IntScanner & operator=(const IntScanner &) = delete;
+
+    bool next(int & value);
+    bool next(long long & value);
+    bool next(size_t & value);
+
+    template< class T >
+    size_t read(T * values, size_t count);
+
+    bool eof() const;
+    bool fail() const;
+    const char * position() const;
+    size_t consumed() const;
+
+  private:
+    static const size_t CHUNK_SIZE = 256 * 1024;
+
+    const char * pos_;
+    const char * end_;
+    const char * start_;
+    size_t done_;
+    std::streambuf * source_;
+    MemoryBuf * memory_;
+    char * buffer_;
+    bool eof_;
+    bool fail_;
+
+    bool refill();
+    bool skipSpaces();
+    bool scanDigits(unsigned long long limit, unsigned long long & result, bool & overflow);
+    template< class T >
+    bool nextSigned(T & value);
+  };
+
+  class StreamReader
+  {
+  public:
+    explicit StreamReader(std::istream & input);
+    ~StreamReader();
+    StreamReader(const StreamReader &) = delete;
+    StreamReader & operator=(const StreamReader &) = delete;
+
+    size_t read(int * values, size_t count);
+    size_t read(long long * values, size_t count);
+    size_t consumed() const;
+
+  private:
+    std::istream & input_;
+    bool good_;
+    IntScanner scanner_;
+  };
+
+  size_t readIntegers(std::istream & input, int * values, size_t count);
+  size_t readIntegers(std::istream & input, long long * values, size_t count);
+  std::istream & readMatrix(std::istream & input, int * mtx, size_t rows, size_t cols);
+  std::istream & readMatrix(std::istream & input, long long * mtx, size_t rows, size_t cols);
+  size_t readIntegers(std::istream & input, PaddedMatrix< int > & mtx);
+  size_t readIntegers(std::istream & input, PaddedMatrix< long long > & mtx);
+}
+
+template< class T >
+size_t common::IntScanner::read(T * values, size_t count)
+{
+  size_t done = 0;
+  while (done < count && next(values[done]))
+  {
+    ++done;
+  }
+  return done;
+}
+
+#endif
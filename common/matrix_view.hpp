@@ -0,0 +1,81 @@
+#ifndef MATRIX_VIEW_HPP
+#define MATRIX_VIEW_HPP
+
+#include <cstddef>
+
+namespace common
+{
+  template< class T >
+  class MatrixView
+  {
+  public:
+    MatrixView(T * data, size_t rows, size_t cols);
+    MatrixView(T * data, size_t rows, size_t cols, size_t stride);
+    template< class U >
+    MatrixView(const MatrixView< U > & other);
+
+    size_t rows() const;
+    size_t cols() const;
+    size_t stride() const;
+    T * row(size_t i) const;
+    MatrixView square() const;
+
+  private:
+    T * data_;
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+  };
+}
+
+template< class T >
+common::MatrixView< T >::MatrixView(T * data, size_t rows, size_t cols):
+  MatrixView(data, rows, cols, cols)
+{}
+
+template< class T >
+common::MatrixView< T >::MatrixView(T * data, size_t rows, size_t cols, size_t stride):
+  data_(data),
+  rows_(rows),
+  cols_(cols),
+  stride_(stride)
+{}
+
+template< class T >
+template< class U >
+common::MatrixView< T >::MatrixView(const MatrixView< U > & other):
+  MatrixView(other.row(0), other.rows(), other.cols(), other.stride())
+{}
+
+template< class T >
+size_t common::MatrixView< T >::rows() const
+{
+  return rows_;
+}
+
+template< class T >
+size_t common::MatrixView< T >::cols() const
+{
+  return cols_;
+}
+
+template< class T >
+size_t common::MatrixView< T >::stride() const
+{
+  return stride_;
+}
+
+template< class T >
+T * common::MatrixView< T >::row(size_t i) const
+{
+  return data_ + i * stride_;
+}
+
+template< class T >
+common::MatrixView< T > common::MatrixView< T >::square() const
+{
+  const size_t side = rows_ < cols_ ? rows_ : cols_;
+  return MatrixView(data_, side, side, stride_);
+}
+
+#endif
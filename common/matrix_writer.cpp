@@ -0,0 +1,225 @@
+#include <matrix_writer.hpp>
+#include <cstdio>
+#include <cstring>
+#include <phase.hpp>
+
+namespace
+{
+  const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+}
+
+size_t common::formatInteger(char * dst, unsigned long long value)
+{
+  char digits[20];
+  char * pos = digits + sizeof(digits);
+  while (value >= 100)
+  {
+    const unsigned pair = static_cast< unsigned >(value % 100) * 2;
+    value /= 100;
+    *--pos = DIGIT_PAIRS[pair + 1];
+    *--pos = DIGIT_PAIRS[pair];
+  }
+  if (value >= 10)
+  {
+    const unsigned pair = static_cast< unsigned >(value) * 2;
+    *--pos = DIGIT_PAIRS[pair + 1];
+    *--pos = DIGIT_PAIRS[pair];
+  }
+  else
+  {
+    *--pos = static_cast< char >('0' + value);
+  }
+  const size_t length = digits + sizeof(digits) - pos;
+  std::memcpy(dst, pos, length);
+  return length;
+}
+
+size_t common::formatInteger(char * dst, long long value)
+{
+  if (value < 0)
+  {
+    *dst = '-';
+    return 1 + formatInteger(dst + 1, 0ull - static_cast< unsigned long long >(value));
+  }
+  return formatInteger(dst, static_cast< unsigned long long >(value));
+}
+
+size_t common::formatTenths(char * dst, long long tenths)
+{
+  size_t length = 0;
+  unsigned long long magnitude = static_cast< unsigned long long >(tenths);
+  if (tenths < 0)
+  {
+    dst[length++] = '-';
+    magnitude = 0ull - magnitude;
+  }
+  length += formatInteger(dst + length, magnitude / 10);
+  const unsigned fraction = static_cast< unsigned >(magnitude % 10);
+  if (fraction != 0)
+  {
+    dst[length++] = '.';
+    dst[length++] = static_cast< char >('0' + fraction);
+  }
+  return length;
+}
+
+common::BufferedWriter::BufferedWriter(std::ostream & out):
+  out_(out),
+  size_(0)
+{}
+
+common::BufferedWriter::~BufferedWriter()
+{
+  flush();
+}
+
+void common::BufferedWriter::flush()
+{
+  if (size_ != 0)
+  {
+    out_.write(buffer_, size_);
+    size_ = 0;
+  }
+}
+
+void common::BufferedWriter::reserve(size_t count)
+{
+  if (BUFFER_SIZE - size_ < count)
+  {
+    flush();
+  }
+}
+
+common::BufferedWriter & common::BufferedWriter::operator<<(char c)
+{
+  reserve(1);
+  buffer_[size_++] = c;
+  return *this;
+}
+
+common::BufferedWriter & common::BufferedWriter::operator<<(const char * str)
+{
+  size_t length = std::strlen(str);
+  if (length > BUFFER_SIZE)
+  {
+    flush();
+    out_.write(str, length);
+    return *this;
+  }
+  reserve(length);
+  std::memcpy(buffer_ + size_, str, length);
+  size_ += length;
+  return *this;
+}
+
+common::BufferedWriter & common::BufferedWriter::operator<<(int value)
+{
+  return *this << static_cast< long long >(value);
+}
+
+common::BufferedWriter & common::BufferedWriter::operator<<(long long value)
+{
+  reserve(MAX_NUMBER);
+  size_ += formatInteger(buffer_ + size_, value);
+  return *this;
+}
+
+common::BufferedWriter & common::BufferedWriter::operator<<(size_t value)
+{
+  reserve(MAX_NUMBER);
+  size_ += formatInteger(buffer_ + size_, static_cast< unsigned long long >(value));
+  return *this;
+}
+
+common::BufferedWriter & common::BufferedWriter::operator<<(double value)
+{
+  reserve(MAX_NUMBER);
+  const int length = std::snprintf(buffer_ + size_, MAX_NUMBER, "%g", value);
+  if (length > 0 && static_cast< size_t >(length) < MAX_NUMBER)
+  {
+    size_ += length;
+  }
+  else
+  {
+    flush();
+    out_ << value;
+  }
+  return *this;
+}
+
+common::BufferedWriter & common::BufferedWriter::writeTenths(long long tenths)
+{
+  reserve(MAX_NUMBER);
+  size_ += formatTenths(buffer_ + size_, tenths);
+  return *this;
+}
+
+template< class T >
+common::BufferedWriter & common::BufferedWriter::writeValues(const T * values, size_t count, char separator)
+{
+  if (count == 0)
+  {
+    return *this;
+  }
+  reserve(MAX_NUMBER);
+  size_ += formatInteger(buffer_ + size_, static_cast< long long >(values[0]));
+  for (size_t i = 1; i < count; ++i)
+  {
+    reserve(MAX_NUMBER + 1);
+    buffer_[size_++] = separator;
+    size_ += formatInteger(buffer_ + size_, static_cast< long long >(values[i]));
+  }
+  return *this;
+}
+
+template< class T >
+common::BufferedWriter & common::BufferedWriter::writeRows(const MatrixView< const T > & mtx, char separator)
+{
+  if (mtx.cols() == 0)
+  {
+    return *this;
+  }
+  for (size_t i = 0; i < mtx.rows(); ++i)
+  {
+    if (i != 0)
+    {
+      *this << separator;
+    }
+    writeValues(mtx.row(i), mtx.cols(), separator);
+  }
+  return *this;
+}
+
+common::BufferedWriter & common::BufferedWriter::write(const int * values, size_t count, char separator)
+{
+  Phase phase("write", count);
+  return writeValues(values, count, separator);
+}
+
+common::BufferedWriter & common::BufferedWriter::write(const long long * values, size_t count, char separator)
+{
+  Phase phase("write", count);
+  return writeValues(values, count, separator);
+}
+
+common::BufferedWriter & common::BufferedWriter::write(const MatrixView< const int > & mtx, char separator)
+{
+  Phase phase("write", mtx.rows() * mtx.cols());
+  return writeRows(mtx, separator);
+}
+
+common::BufferedWriter & common::BufferedWriter::write(const MatrixView< const long long > & mtx, char separator)
+{
+  Phase phase("write", mtx.rows() * mtx.cols());
+  return writeRows(mtx, separator);
+}
@@ -0,0 +1,51 @@
+#ifndef MATRIX_WRITER_HPP
+#define MATRIX_WRITER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <matrix_view.hpp>
+
+namespace common
+{
+  size_t formatInteger(char * dst, long long value);
+  size_t formatInteger(char * dst, unsigned long long value);
+  size_t formatTenths(char * dst, long long tenths);
+
+  class BufferedWriter
+  {
+  public:
+    explicit BufferedWriter(std::ostream & out);
+    ~BufferedWriter();
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter & operator=(const BufferedWriter &) = delete;
+
+    BufferedWriter & operator<<(char c);
+    BufferedWriter & operator<<(const char * str);
+    BufferedWriter & operator<<(int value);
+    BufferedWriter & operator<<(long long value);
+    BufferedWriter & operator<<(size_t value);
+    BufferedWriter & operator<<(double value);
+    BufferedWriter & writeTenths(long long tenths);
+    BufferedWriter & write(const int * values, size_t count, char separator);
+    BufferedWriter & write(const long long * values, size_t count, char separator);
+    BufferedWriter & write(const MatrixView< const int > & mtx, char separator);
+    BufferedWriter & write(const MatrixView< const long long > & mtx, char separator);
+    void flush();
+
+  private:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+    static const size_t MAX_NUMBER = 24;
+
+    std::ostream & out_;
+    size_t size_;
+    char buffer_[BUFFER_SIZE];
+
+    void reserve(size_t count);
+    template< class T >
+    BufferedWriter & writeValues(const T * values, size_t count, char separator);
+    template< class T >
+    BufferedWriter & writeRows(const MatrixView< const T > & mtx, char separator);
+  };
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef MULTI_QUERY_HPP
+#define MULTI_QUERY_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <matrix_view.hpp>
+#include <parallel.hpp>
+
+namespace common
+{
+  template< class... Queries >
+  class MultiQuery
+  {
+  public:
+    explicit MultiQuery(const Queries &... queries);
+
+    template< class T >
+    void operator()(const T * above, const T * row, const T * below, size_t cols);
+    void merge(const MultiQuery & other);
+    void seek(size_t row);
+
+    template< size_t I >
+    const typename std::tuple_element< I, std::tuple< Queries... > >::type & get() const;
+
+  private:
+    std::tuple< Queries... > queries_;
+    size_t row_;
+
+    template< class T, size_t... I >
+    void apply(std::index_sequence< I... >, const T * above, const T * row, const T * below, size_t cols);
+    template< size_t... I >
+    void mergeAll(std::index_sequence< I... >, const MultiQuery & other);
+  };
+
+  template< class... Queries >
+  MultiQuery< Queries... > makeQueries(const Queries &... queries);
+  template< class T, class... Queries >
+  void scanQueries(const MatrixView< const T > & mtx, MultiQuery< Queries... > & queries);
+  template< class T, class... Queries >
+  void scanQueries(const T * mtx, size_t rows, size_t cols, MultiQuery< Queries... > & queries);
+}
+
+namespace common
+{
+  namespace detail
+  {
+    template< class Query, class T >
+    auto runQuery(Query & query, size_t i, const T * above, const T * row, const T * below, size_t cols, int)
+        -> decltype(query(i, above, row, below, cols), void())
+    {
+      query(i, above, row, below, cols);
+    }
+
+    template< class Query, class T >
+    void runQuery(Query & query, size_t, const T * above, const T * row, const T * below, size_t cols, long)
+    {
+      query(above, row, below, cols);
+    }
+  }
+}
+
+template< class... Queries >
+common::MultiQuery< Queries... >::MultiQuery(const Queries &... queries):
+  queries_(queries...),
+  row_(0)
+{}
+
+template< class... Queries >
+template< class T >
+void common::MultiQuery< Queries... >::operator()(const T * above, const T * row, const T * below, size_t cols)
+{
+  apply(std::index_sequence_for< Queries... >(), above, row, below, cols);
+  ++row_;
+}
+
+template< class... Queries >
+void common::MultiQuery< Queries... >::merge(const MultiQuery & other)
+{
+  mergeAll(std::index_sequence_for< Queries... >(), other);
+}
+
+template< class... Queries >
+void common::MultiQuery< Queries... >::seek(size_t row)
+{
+  row_ = row;
+}
+
+template< class... Queries >
+template< size_t I >
+const typename std::tuple_element< I, std::tuple< Queries... > >::type &
+    common::MultiQuery< Queries... >::get() const
+{
+  return std::get< I >(queries_);
+}
+
+template< class... Queries >
+template< class T, size_t... I >
+void common::MultiQuery< Queries... >::apply(std::index_sequence< I... >, const T * above, const T * row,
+    const T * below, size_t cols)
+{
+  const int expand[] = { 0, (detail::runQuery(std::get< I >(queries_), row_, above, row, below, cols, 0), 0)... };
+  static_cast< void >(expand);
+}
+
+template< class... Queries >
+template< size_t... I >
+void common::MultiQuery< Queries... >::mergeAll(std::index_sequence< I... >, const MultiQuery & other)
+{
+  const int expand[] = { 0, (std::get< I >(queries_).merge(std::get< I >(other.queries_)), 0)... };
+  static_cast< void >(expand);
+}
+
+template< class... Queries >
+common::MultiQuery< Queries... > common::makeQueries(const Queries &... queries)
+{
+  return MultiQuery< Queries... >(queries...);
+}
+
+template< class T, class... Queries >
+void common::scanQueries(const MatrixView< const T > & mtx, MultiQuery< Queries... > & queries)
+{
+  const size_t rows = mtx.rows();
+  const size_t cols = mtx.cols();
+  parallelTiles(rows, cols, queries, [&mtx, rows, cols](MultiQuery< Queries... > & part, size_t begin, size_t end)
+  {
+    part.seek(begin);
+    recordTile(mtx.row(begin), (end - begin) * mtx.stride() * sizeof(T));
+    for (size_t i = begin; i < end; ++i)
+    {
+      const T * above = i > 0 ? mtx.row(i - 1) : nullptr;
+      const T * below = i + 1 < rows ? mtx.row(i + 1) : nullptr;
+      part(above, mtx.row(i), below, cols);
+    }
+  });
+}
+
+template< class T, class... Queries >
+void common::scanQueries(const T * mtx, size_t rows, size_t cols, MultiQuery< Queries... > & queries)
+{
+  scanQueries(MatrixView< const T >(mtx, rows, cols), queries);
+}
+
+#endif
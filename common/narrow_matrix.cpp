@@ -0,0 +1,214 @@
+#include <narrow_matrix.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <alloc_profile.hpp>
+#include <matrix_reader.hpp>
+#include <phase.hpp>
+
+namespace
+{
+  using common::ElementWidth;
+
+  const size_t BLOCK = 4096;
+
+  template< class T >
+  void storeAs(char * dest, const int * values, size_t count)
+  {
+    T block[BLOCK];
+    for (size_t i = 0; i < count; ++i)
+    {
+      block[i] = static_cast< T >(values[i]);
+    }
+    std::memcpy(dest, block, count * sizeof(T));
+  }
+
+  template< class T >
+  void loadAs(const char * src, int * values, size_t count)
+  {
+    T block[BLOCK];
+    std::memcpy(block, src, count * sizeof(T));
+    for (size_t i = 0; i < count; ++i)
+    {
+      values[i] = block[i];
+    }
+  }
+
+  void store(ElementWidth width, char * dest, const int * values, size_t count)
+  {
+    switch (width)
+    {
+    case ElementWidth::int8:
+      storeAs< std::int8_t >(dest, values, count);
+      break;
+    case ElementWidth::int16:
+      storeAs< std::int16_t >(dest, values, count);
+      break;
+    case ElementWidth::int32:
+      std::memcpy(dest, values, count * sizeof(int));
+      break;
+    }
+  }
+
+  void load(ElementWidth width, const char * src, int * values, size_t count)
+  {
+    switch (width)
+    {
+    case ElementWidth::int8:
+      loadAs< std::int8_t >(src, values, count);
+      break;
+    case ElementWidth::int16:
+      loadAs< std::int16_t >(src, values, count);
+      break;
+    case ElementWidth::int32:
+      std::memcpy(values, src, count * sizeof(int));
+      break;
+    }
+  }
+
+  void widen(char * data, size_t count, ElementWidth from, ElementWidth to)
+  {
+    const size_t narrow = common::elementSize(from);
+    const size_t wide = common::elementSize(to);
+    int values[BLOCK];
+    for (size_t end = count; end > 0; )
+    {
+      const size_t begin = (end - 1) / BLOCK * BLOCK;
+      load(from, data + begin * narrow, values, end - begin);
+      store(to, data + begin * wide, values, end - begin);
+      end = begin;
+    }
+  }
+}
+
+common::ElementWidth common::narrowestWidth(int low, int high)
+{
+  if (low >= std::numeric_limits< std::int8_t >::min() && high <= std::numeric_limits< std::int8_t >::max())
+  {
+    return ElementWidth::int8;
+  }
+  if (low >= std::numeric_limits< std::int16_t >::min() && high <= std::numeric_limits< std::int16_t >::max())
+  {
+    return ElementWidth::int16;
+  }
+  return ElementWidth::int32;
+}
+
+size_t common::elementSize(ElementWidth width)
+{
+  switch (width)
+  {
+  case ElementWidth::int8:
+    return sizeof(std::int8_t);
+  case ElementWidth::int16:
+    return sizeof(std::int16_t);
+  case ElementWidth::int32:
+    return sizeof(int);
+  }
+  return 0;
+}
+
+common::NarrowMatrix::NarrowMatrix(size_t rows, size_t cols):
+  storage_(nullptr),
+  reserved_(0),
+  rows_(rows),
+  cols_(cols),
+  width_(ElementWidth::int8)
+{}
+
+common::NarrowMatrix::~NarrowMatrix()
+{
+  if (storage_ && allocationProfile())
+  {
+    recordRelease(reserved_);
+  }
+  std::free(storage_);
+}
+
+void common::NarrowMatrix::reserve(ElementWidth width)
+{
+  const size_t count = rows_ * cols_;
+  if (count > std::numeric_limits< size_t >::max() / elementSize(width))
+  {
+    throw std::bad_array_new_length();
+  }
+  const size_t bytes = count * elementSize(width);
+  if (bytes <= reserved_ && storage_)
+  {
+    return;
+  }
+  char * grown = static_cast< char * >(std::realloc(storage_, bytes ? bytes : 1));
+  if (!grown)
+  {
+    throw std::bad_alloc();
+  }
+  if (allocationProfile())
+  {
+    if (storage_)
+    {
+      recordRelease(reserved_);
+    }
+    recordAllocation(bytes);
+  }
+  storage_ = grown;
+  reserved_ = bytes;
+}
+
+size_t common::NarrowMatrix::read(std::istream & input)
+{
+  const size_t count = rows_ * cols_;
+  width_ = ElementWidth::int8;
+  reserve(width_);
+  if (count == 0)
+  {
+    return 0;
+  }
+  Phase phase("read", count);
+  StreamReader reader(input);
+  int values[BLOCK];
+  int low = 0;
+  int high = 0;
+  size_t done = 0;
+  while (done < count)
+  {
+    const size_t want = std::min(BLOCK, count - done);
+    const size_t got = reader.read(values, want);
+    for (size_t i = 0; i < got; ++i)
+    {
+      low = std::min(low, values[i]);
+      high = std::max(high, values[i]);
+    }
+    const ElementWidth need = narrowestWidth(low, high);
+    if (need > width_)
+    {
+      reserve(need);
+      widen(storage_, done, width_, need);
+      width_ = need;
+    }
+    store(width_, storage_ + done * elementSize(width_), values, got);
+    done += got;
+    if (got != want)
+    {
+      break;
+    }
+  }
+  phase.addBytes(reader.consumed());
+  return done;
+}
+
+size_t common::NarrowMatrix::rows() const
+{
+  return rows_;
+}
+
+size_t common::NarrowMatrix::cols() const
+{
+  return cols_;
+}
+
+common::ElementWidth common::NarrowMatrix::width() const
+{
+  return width_;
+}
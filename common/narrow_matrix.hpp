@@ -0,0 +1,73 @@
+#ifndef NARROW_MATRIX_HPP
+#define NARROW_MATRIX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <matrix_view.hpp>
+
+namespace common
+{
+  enum class ElementWidth
+  {
+    int8,
+    int16,
+    int32
+  };
+
+  ElementWidth narrowestWidth(int low, int high);
+  size_t elementSize(ElementWidth width);
+
+  class NarrowMatrix
+  {
+  public:
+    NarrowMatrix(size_t rows, size_t cols);
+    ~NarrowMatrix();
+    NarrowMatrix(const NarrowMatrix &) = delete;
+    NarrowMatrix & operator=(const NarrowMatrix &) = delete;
+
+    size_t read(std::istream & input);
+
+    size_t rows() const;
+    size_t cols() const;
+    ElementWidth width() const;
+    template< class T >
+    MatrixView< const T > view() const;
+    template< class Fn >
+    void visit(Fn fn) const;
+
+  private:
+    char * storage_;
+    size_t reserved_;
+    size_t rows_;
+    size_t cols_;
+    ElementWidth width_;
+
+    void reserve(ElementWidth width);
+  };
+}
+
+template< class T >
+common::MatrixView< const T > common::NarrowMatrix::view() const
+{
+  return MatrixView< const T >(reinterpret_cast< const T * >(storage_), rows_, cols_);
+}
+
+template< class Fn >
+void common::NarrowMatrix::visit(Fn fn) const
+{
+  switch (width_)
+  {
+  case ElementWidth::int8:
+    fn(view< std::int8_t >());
+    break;
+  case ElementWidth::int16:
+    fn(view< std::int16_t >());
+    break;
+  case ElementWidth::int32:
+    fn(view< int >());
+    break;
+  }
+}
+
+#endif
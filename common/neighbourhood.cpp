@@ -0,0 +1,218 @@
+#include <neighbourhood.hpp>
+#include <limits>
+#include <type_traits>
+#include <gpu.hpp>
+#include <parallel.hpp>
+#include <simd_kernels.hpp>
+
+namespace
+{
+  template< class Compare >
+  struct TestIndex;
+
+  template<>
+  struct TestIndex< common::StrictMax >
+  {
+    static const size_t value = 0;
+  };
+
+  template<>
+  struct TestIndex< common::StrictMin >
+  {
+    static const size_t value = 1;
+  };
+
+  template<>
+  struct TestIndex< common::WeakMax >
+  {
+    static const size_t value = 2;
+  };
+
+  template<>
+  struct TestIndex< common::WeakMin >
+  {
+    static const size_t value = 3;
+  };
+
+  template< class Shape >
+  struct ShapeIndex;
+
+  template<>
+  struct ShapeIndex< common::CrossShape >
+  {
+    static const size_t value = 0;
+  };
+
+  template<>
+  struct ShapeIndex< common::SquareShape >
+  {
+    static const size_t value = 1;
+  };
+
+  template< class Compare, class Shape, class T >
+  typename common::simd::TypeKernels< T >::ExtremaKernel extremaKernel()
+  {
+    return common::simd::kernelsFor< T >().extrema[TestIndex< Compare >::value][ShapeIndex< Shape >::value];
+  }
+
+  template< class Compare >
+  struct Sentinel;
+
+  template<>
+  struct Sentinel< common::StrictMax >
+  {
+    template< class T >
+    static T value()
+    {
+      return std::numeric_limits< T >::max();
+    }
+  };
+
+  template<>
+  struct Sentinel< common::StrictMin >
+  {
+    template< class T >
+    static T value()
+    {
+      return std::numeric_limits< T >::min();
+    }
+  };
+
+  struct ExtremaCount
+  {
+    size_t value;
+
+    void merge(const ExtremaCount & other)
+    {
+      value += other.value;
+    }
+  };
+
+  bool offloadExtrema(const common::PaddedMatrix< int > & mtx, bool minimum, bool square, size_t & count)
+  {
+    if (!common::gpuOffload(mtx.rows() * mtx.cols()))
+    {
+      return false;
+    }
+    common::GpuMatrix device;
+    const size_t cells = (mtx.rows() - 1) * mtx.stride() + mtx.cols();
+    return device.allocate(mtx.rows(), mtx.cols(), mtx.stride()) && device.upload(0, mtx.row(0), cells)
+        && device.countExtrema(minimum, square, count);
+  }
+
+  bool offloadExtrema(const common::PaddedMatrix< long long > &, bool, bool, size_t &)
+  {
+    return false;
+  }
+}
+
+template< class Compare, class Shape, class T >
+size_t common::countExtremaRow(const T * above, const T * row, const T * below, size_t cols)
+{
+  const T * const rows[] = { above, row, below };
+  if (cols < 2)
+  {
+    return 0;
+  }
+  return extremaKernel< Compare, Shape, T >()(rows, 1, cols - 1);
+}
+
+template< class Compare, class Shape, class T >
+size_t common::countExtrema(PaddedMatrix< T > & mtx)
+{
+  size_t offloaded = 0;
+  const bool minimum = std::is_same< Compare, StrictMin >::value;
+  if (offloadExtrema(mtx, minimum, std::is_same< Shape, SquareShape >::value, offloaded))
+  {
+    return offloaded;
+  }
+  mtx.fillBorder(Sentinel< Compare >::template value< T >());
+  const size_t width = simd::kernelsFor< T >().width;
+  const size_t end = (mtx.cols() + width - 1) / width * width;
+  const auto kernel = extremaKernel< Compare, Shape, T >();
+  const PaddedMatrix< T > & padded = mtx;
+  ExtremaCount count = { 0 };
+  parallelTiles(mtx.rows(), mtx.cols(), count, [&padded, end, kernel](ExtremaCount & part, size_t begin, size_t last)
+  {
+    recordTile(padded.row(begin), (last - begin) * padded.stride() * sizeof(T));
+    for (size_t i = begin; i < last; ++i)
+    {
+      const T * const rows[] = { padded.row(i) - padded.stride(), padded.row(i), padded.row(i) + padded.stride() };
+      part.value += kernel(rows, 0, end);
+    }
+  });
+  return count.value;
+}
+
+template size_t common::countExtremaRow< common::StrictMax, common::CrossShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::CrossShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::CrossShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::CrossShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::CrossShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::CrossShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::CrossShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::CrossShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::SquareShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::SquareShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::SquareShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::SquareShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::SquareShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::SquareShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::SquareShape >(const int *,
+    const int *, const int *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::SquareShape >(const long long *,
+    const long long *, const long long *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::CrossShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::CrossShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::CrossShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::CrossShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::CrossShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::CrossShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::CrossShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::CrossShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::SquareShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMax, common::SquareShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::SquareShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::StrictMin, common::SquareShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::SquareShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMax, common::SquareShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::SquareShape >(const std::int8_t *,
+    const std::int8_t *, const std::int8_t *, size_t);
+template size_t common::countExtremaRow< common::WeakMin, common::SquareShape >(const std::int16_t *,
+    const std::int16_t *, const std::int16_t *, size_t);
+template size_t common::countExtrema< common::StrictMax, common::CrossShape >(PaddedMatrix< int > &);
+template size_t common::countExtrema< common::StrictMax, common::CrossShape >(PaddedMatrix< long long > &);
+template size_t common::countExtrema< common::StrictMax, common::SquareShape >(PaddedMatrix< int > &);
+template size_t common::countExtrema< common::StrictMax, common::SquareShape >(PaddedMatrix< long long > &);
+template size_t common::countExtrema< common::StrictMin, common::CrossShape >(PaddedMatrix< int > &);
+template size_t common::countExtrema< common::StrictMin, common::CrossShape >(PaddedMatrix< long long > &);
+template size_t common::countExtrema< common::StrictMin, common::SquareShape >(PaddedMatrix< int > &);
+template size_t common::countExtrema< common::StrictMin, common::SquareShape >(PaddedMatrix< long long > &);
@@ -0,0 +1,71 @@
+#ifndef NEIGHBOURHOOD_HPP
+#define NEIGHBOURHOOD_HPP
+
+#include <cstddef>
+#include <padded_matrix.hpp>
+
+namespace common
+{
+  struct StrictMax {};
+  struct StrictMin {};
+  struct WeakMax {};
+  struct WeakMin {};
+
+  struct CrossShape {};
+  struct SquareShape {};
+
+  template< class Compare, class Shape, class T >
+  size_t countExtremaRow(const T * above, const T * row, const T * below, size_t cols);
+  template< class Compare, class Shape, class T >
+  size_t countExtrema(PaddedMatrix< T > & mtx);
+
+  template< class T, class Compare, class Shape >
+  class ExtremumCounter
+  {
+  public:
+    ExtremumCounter();
+    void operator()(const T * above, const T * row, const T * below, size_t cols);
+    void merge(const ExtremumCounter & other);
+    size_t count() const;
+
+  private:
+    size_t count_;
+  };
+
+  template< class T >
+  using LocalMaxCounter = ExtremumCounter< T, StrictMax, SquareShape >;
+  template< class T >
+  using LocalMinCounter = ExtremumCounter< T, StrictMin, SquareShape >;
+  template< class T >
+  using CrossMaxCounter = ExtremumCounter< T, StrictMax, CrossShape >;
+}
+
+template< class T, class Compare, class Shape >
+common::ExtremumCounter< T, Compare, Shape >::ExtremumCounter():
+  count_(0)
+{}
+
+template< class T, class Compare, class Shape >
+void common::ExtremumCounter< T, Compare, Shape >::operator()(const T * above, const T * row, const T * below,
+    size_t cols)
+{
+  if (!above || !below)
+  {
+    return;
+  }
+  count_ += countExtremaRow< Compare, Shape >(above, row, below, cols);
+}
+
+template< class T, class Compare, class Shape >
+void common::ExtremumCounter< T, Compare, Shape >::merge(const ExtremumCounter & other)
+{
+  count_ += other.count_;
+}
+
+template< class T, class Compare, class Shape >
+size_t common::ExtremumCounter< T, Compare, Shape >::count() const
+{
+  return count_;
+}
+
+#endif
@@ -0,0 +1,172 @@
+#include <numa.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <matrix_writer.hpp>
+#include <parallel.hpp>
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const size_t PAGE_SIZE = 4096;
+
+  std::atomic< size_t > tracked_tiles(0);
+  std::atomic< size_t > remote_tiles(0);
+  std::atomic< unsigned long long > remote_bytes(0);
+
+  size_t countNodes()
+  {
+    size_t nodes = 0;
+#ifdef __linux__
+    DIR * dir = opendir("/sys/devices/system/node");
+    if (!dir)
+    {
+      return 1;
+    }
+    while (const dirent * entry = readdir(dir))
+    {
+      if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+      {
+        ++nodes;
+      }
+    }
+    closedir(dir);
+#endif
+    return nodes > 0 ? nodes : 1;
+  }
+
+#ifdef __linux__
+  bool currentNode(int & node)
+  {
+    unsigned cpu = 0;
+    unsigned current = 0;
+    if (syscall(SYS_getcpu, &cpu, &current, nullptr) != 0)
+    {
+      return false;
+    }
+    node = static_cast< int >(current);
+    return true;
+  }
+
+  bool pageNode(const void * address, int & node)
+  {
+    return syscall(SYS_get_mempolicy, &node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) == 0;
+  }
+#endif
+}
+
+std::atomic< bool > common::detail::numa_tracking(false);
+
+size_t common::numaNodes()
+{
+  static const size_t nodes = countNodes();
+  return nodes;
+}
+
+bool common::numaPlacement()
+{
+  const char * value = std::getenv("MATRIX_NUMA");
+  if (value && *value)
+  {
+    return std::strcmp(value, "0") != 0;
+  }
+  return numaNodes() > 1;
+}
+
+bool common::pinWorker(size_t worker)
+{
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) <= 0)
+  {
+    return false;
+  }
+  size_t skip = worker % static_cast< size_t >(CPU_COUNT(&allowed));
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if (!CPU_ISSET(cpu, &allowed) || skip-- != 0)
+    {
+      continue;
+    }
+    cpu_set_t single;
+    CPU_ZERO(&single);
+    CPU_SET(cpu, &single);
+    return pthread_setaffinity_np(pthread_self(), sizeof(single), &single) == 0;
+  }
+#else
+  static_cast< void >(worker);
+#endif
+  return false;
+}
+
+void common::placeRows(void * data, size_t rows, size_t cols, size_t row_bytes)
+{
+  const size_t tiles = tileCount(rows, cols);
+  if (!data || tiles <= 1 || !numaPlacement())
+  {
+    return;
+  }
+  char * const base = static_cast< char * >(data);
+  const uintptr_t origin = reinterpret_cast< uintptr_t >(base);
+  ThreadPool::shared().run(tiles, [base, origin, rows, tiles, row_bytes](size_t tile)
+  {
+    const size_t begin = rows * tile / tiles * row_bytes;
+    const size_t end = rows * (tile + 1) / tiles * row_bytes;
+    const size_t first = (origin + begin + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE - origin;
+    for (size_t offset = first; offset < end; offset += PAGE_SIZE)
+    {
+      base[offset] = 0;
+    }
+  });
+}
+
+void common::trackNuma(bool on)
+{
+  tracked_tiles = 0;
+  remote_tiles = 0;
+  remote_bytes = 0;
+  detail::numa_tracking = on;
+}
+
+void common::detail::recordRemote(const void * data, size_t bytes)
+{
+#ifdef __linux__
+  int here = 0;
+  int there = 0;
+  if (!currentNode(here) || !pageNode(data, there))
+  {
+    return;
+  }
+  ++tracked_tiles;
+  if (here != there)
+  {
+    ++remote_tiles;
+    remote_bytes += bytes;
+  }
+#else
+  static_cast< void >(data);
+  static_cast< void >(bytes);
+#endif
+}
+
+common::NumaTraffic common::numaTraffic()
+{
+  NumaTraffic traffic = { numaNodes(), tracked_tiles, remote_tiles, remote_bytes };
+  return traffic;
+}
+
+void common::printNuma(std::ostream & out, const NumaTraffic & traffic)
+{
+  BufferedWriter writer(out);
+  writer << "nodes tiles remote remote-bytes\n";
+  writer << traffic.nodes << ' ' << traffic.tiles << ' ' << traffic.remote << ' ';
+  writer << static_cast< size_t >(traffic.remote_bytes) << '\n';
+}
@@ -0,0 +1,43 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+namespace common
+{
+  struct NumaTraffic
+  {
+    size_t nodes;
+    size_t tiles;
+    size_t remote;
+    unsigned long long remote_bytes;
+  };
+
+  size_t numaNodes();
+  bool numaPlacement();
+  bool pinWorker(size_t worker);
+  void placeRows(void * data, size_t rows, size_t cols, size_t row_bytes);
+
+  void trackNuma(bool on);
+  void recordTile(const void * data, size_t bytes);
+  NumaTraffic numaTraffic();
+  void printNuma(std::ostream & out, const NumaTraffic & traffic);
+
+  namespace detail
+  {
+    extern std::atomic< bool > numa_tracking;
+    void recordRemote(const void * data, size_t bytes);
+  }
+}
+
+inline void common::recordTile(const void * data, size_t bytes)
+{
+  if (detail::numa_tracking.load(std::memory_order_relaxed))
+  {
+    detail::recordRemote(data, bytes);
+  }
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef PADDED_MATRIX_HPP
+#define PADDED_MATRIX_HPP
+
+#include <cstddef>
+#include <limits>
+#include <arena.hpp>
+#include <matrix_view.hpp>
+
+namespace common
+{
+  template< class T >
+  class PaddedMatrix
+  {
+  public:
+    static const size_t PAD = Arena::ALIGNMENT / sizeof(T);
+
+    PaddedMatrix(size_t rows, size_t cols);
+    PaddedMatrix(const PaddedMatrix &) = delete;
+    PaddedMatrix & operator=(const PaddedMatrix &) = delete;
+
+    bool allocated() const;
+    size_t rows() const;
+    size_t cols() const;
+    size_t stride() const;
+    T * row(size_t i);
+    const T * row(size_t i) const;
+    void fillBorder(T value);
+    MatrixView< T > view();
+    MatrixView< const T > view() const;
+
+  private:
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+    size_t size_;
+    Arena arena_;
+    T * data_;
+
+    static size_t strideFor(size_t cols);
+    static size_t sizeFor(size_t rows, size_t stride);
+  };
+}
+
+template< class T >
+common::PaddedMatrix< T >::PaddedMatrix(size_t rows, size_t cols):
+  rows_(rows),
+  cols_(cols),
+  stride_(strideFor(cols)),
+  size_(sizeFor(rows, stride_)),
+  arena_(Arena::bytes< T >(size_)),
+  data_(size_ ? arena_.allocate< T >(size_) : nullptr)
+{}
+
+template< class T >
+bool common::PaddedMatrix< T >::allocated() const
+{
+  return data_ != nullptr;
+}
+
+template< class T >
+size_t common::PaddedMatrix< T >::rows() const
+{
+  return rows_;
+}
+
+template< class T >
+size_t common::PaddedMatrix< T >::cols() const
+{
+  return cols_;
+}
+
+template< class T >
+size_t common::PaddedMatrix< T >::stride() const
+{
+  return stride_;
+}
+
+template< class T >
+T * common::PaddedMatrix< T >::row(size_t i)
+{
+  return data_ + PAD + (i + 1) * stride_;
+}
+
+template< class T >
+const T * common::PaddedMatrix< T >::row(size_t i) const
+{
+  return data_ + PAD + (i + 1) * stride_;
+}
+
+template< class T >
+void common::PaddedMatrix< T >::fillBorder(T value)
+{
+  T * const last = data_ + size_;
+  for (T * cell = data_; cell != row(0); ++cell)
+  {
+    *cell = value;
+  }
+  for (size_t i = 0; i < rows_; ++i)
+  {
+    T * const end = row(i) + stride_;
+    for (T * cell = row(i) + cols_; cell != end; ++cell)
+    {
+      *cell = value;
+    }
+  }
+  for (T * cell = row(rows_); cell != last; ++cell)
+  {
+    *cell = value;
+  }
+}
+
+template< class T >
+common::MatrixView< T > common::PaddedMatrix< T >::view()
+{
+  return MatrixView< T >(row(0), rows_, cols_, stride_);
+}
+
+template< class T >
+common::MatrixView< const T > common::PaddedMatrix< T >::view() const
+{
+  return MatrixView< const T >(row(0), rows_, cols_, stride_);
+}
+
+template< class T >
+size_t common::PaddedMatrix< T >::strideFor(size_t cols)
+{
+  if (cols > std::numeric_limits< size_t >::max() - 2 * PAD)
+  {
+    return 0;
+  }
+  return (cols + PAD - 1) / PAD * PAD + PAD;
+}
+
+template< class T >
+size_t common::PaddedMatrix< T >::sizeFor(size_t rows, size_t stride)
+{
+  if (stride == 0 || rows > (std::numeric_limits< size_t >::max() - PAD) / stride - 2)
+  {
+    return 0;
+  }
+  return (rows + 2) * stride + PAD;
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include <parallel.hpp>
+#include <cstdlib>
+
+namespace
+{
+  const size_t MIN_TILE_CELLS = 1 << 18;
+  const size_t TILES_PER_THREAD = 4;
+
+  thread_local const common::ThreadPool * current_pool = nullptr;
+  thread_local size_t current_queue = 0;
+}
+
+common::ThreadPool::ThreadPool(size_t workers):
+  queued_(0),
+  placed_(workers > 0 && numaPlacement()),
+  stop_(false)
+{
+  queues_.reserve(workers + 1);
+  for (size_t i = 0; i <= workers; ++i)
+  {
+    queues_.emplace_back(new Queue);
+  }
+  workers_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i)
+  {
+    workers_.emplace_back(&ThreadPool::work, this, i + 1);
+  }
+}
+
+common::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+  {
+    workers_[i].join();
+  }
+}
+
+size_t common::ThreadPool::size() const
+{
+  return workers_.size() + 1;
+}
+
+size_t common::ThreadPool::self() const
+{
+  return current_pool == this ? current_queue : 0;
+}
+
+bool common::ThreadPool::take(size_t self, Task & task)
+{
+  if (queued_ == 0)
+  {
+    return false;
+  }
+  {
+    Queue & own = *queues_[self];
+    std::lock_guard< std::mutex > lock(own.mutex);
+    if (!own.tasks.empty())
+    {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      --queued_;
+      return true;
+    }
+  }
+  for (size_t step = 1; step < queues_.size(); ++step)
+  {
+    Queue & victim = *queues_[(self + step) % queues_.size()];
+    std::lock_guard< std::mutex > lock(victim.mutex);
+    if (!victim.tasks.empty())
+    {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      --queued_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void common::ThreadPool::execute(const Task & task)
+{
+  (*task.group->task)(task.index);
+  if (--task.group->pending == 0)
+  {
+    {
+      std::lock_guard< std::mutex > lock(mutex_);
+    }
+    wake_.notify_all();
+  }
+}
+
+void common::ThreadPool::work(size_t self)
+{
+  current_pool = this;
+  current_queue = self;
+  if (placed_)
+  {
+    pinWorker(self);
+  }
+  Task task = { nullptr, 0 };
+  while (true)
+  {
+    if (take(self, task))
+    {
+      execute(task);
+      continue;
+    }
+    std::unique_lock< std::mutex > lock(mutex_);
+    wake_.wait(lock, [this]()
+    {
+      return stop_ || queued_ > 0;
+    });
+    if (stop_)
+    {
+      return;
+    }
+  }
+}
+
+void common::ThreadPool::run(size_t tasks, const std::function< void(size_t) > & task)
+{
+  if (tasks == 0)
+  {
+    return;
+  }
+  const size_t own = self();
+  Group group;
+  group.task = &task;
+  group.pending = tasks;
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    queued_ += tasks;
+  }
+  if (placed_)
+  {
+    for (size_t i = 0; i < tasks; ++i)
+    {
+      Queue & home = *queues_[i % queues_.size()];
+      std::lock_guard< std::mutex > lock(home.mutex);
+      home.tasks.push_back(Task{ &group, i });
+    }
+  }
+  else
+  {
+    Queue & queue = *queues_[own];
+    std::lock_guard< std::mutex > lock(queue.mutex);
+    for (size_t i = tasks; i > 0; --i)
+    {
+      queue.tasks.push_back(Task{ &group, i - 1 });
+    }
+  }
+  wake_.notify_all();
+  Task next = { nullptr, 0 };
+  while (group.pending > 0)
+  {
+    if (take(own, next))
+    {
+      execute(next);
+      continue;
+    }
+    std::unique_lock< std::mutex > lock(mutex_);
+    wake_.wait(lock, [this, &group]()
+    {
+      return group.pending == 0 || queued_ > 0;
+    });
+  }
+}
+
+common::ThreadPool & common::ThreadPool::shared()
+{
+  static ThreadPool pool(threadCount() - 1);
+  return pool;
+}
+
+size_t common::threadCount()
+{
+  const char * value = std::getenv("MATRIX_THREADS");
+  if (value && *value)
+  {
+    const long threads = std::strtol(value, nullptr, 10);
+    return threads > 0 ? static_cast< size_t >(threads) : 1;
+  }
+  const unsigned hardware = std::thread::hardware_concurrency();
+  return hardware > 0 ? hardware : 1;
+}
+
+size_t common::tileCount(size_t rows, size_t cols)
+{
+  if (rows < 2 || cols == 0)
+  {
+    return 1;
+  }
+  const size_t threads = threadCount();
+  size_t tiles = threads > 1 ? threads * TILES_PER_THREAD : 1;
+  const size_t byCells = rows * cols / MIN_TILE_CELLS;
+  if (byCells < tiles)
+  {
+    tiles = byCells;
+  }
+  if (rows < tiles)
+  {
+    tiles = rows;
+  }
+  return tiles > 0 ? tiles : 1;
+}
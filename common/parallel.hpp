@@ -0,0 +1,118 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <matrix_view.hpp>
+#include <numa.hpp>
+
+namespace common
+{
+  class ThreadPool
+  {
+  public:
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    size_t size() const;
+    void run(size_t tasks, const std::function< void(size_t) > & task);
+
+    static ThreadPool & shared();
+
+  private:
+    struct Group
+    {
+      const std::function< void(size_t) > * task;
+      std::atomic< size_t > pending;
+    };
+
+    struct Task
+    {
+      Group * group;
+      size_t index;
+    };
+
+    struct Queue
+    {
+      std::mutex mutex;
+      std::deque< Task > tasks;
+    };
+
+    std::vector< std::thread > workers_;
+    std::vector< std::unique_ptr< Queue > > queues_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic< size_t > queued_;
+    bool placed_;
+    bool stop_;
+
+    void work(size_t self);
+    size_t self() const;
+    bool take(size_t self, Task & task);
+    void execute(const Task & task);
+  };
+
+  size_t threadCount();
+  size_t tileCount(size_t rows, size_t cols);
+
+  template< class Part, class Fn >
+  void parallelTiles(size_t rows, size_t cols, Part & result, Fn fn);
+  template< class T, class Kernel >
+  void parallelScanRows(const T * mtx, size_t rows, size_t cols, Kernel & kernel);
+  template< class T, class Kernel >
+  void parallelScanRows(const MatrixView< const T > & mtx, Kernel & kernel);
+}
+
+template< class Part, class Fn >
+void common::parallelTiles(size_t rows, size_t cols, Part & result, Fn fn)
+{
+  const size_t tiles = tileCount(rows, cols);
+  if (tiles <= 1)
+  {
+    fn(result, 0, rows);
+    return;
+  }
+  std::vector< Part > parts(tiles, result);
+  ThreadPool::shared().run(tiles, [&](size_t tile)
+  {
+    fn(parts[tile], rows * tile / tiles, rows * (tile + 1) / tiles);
+  });
+  for (size_t tile = 0; tile < tiles; ++tile)
+  {
+    result.merge(parts[tile]);
+  }
+}
+
+template< class T, class Kernel >
+void common::parallelScanRows(const T * mtx, size_t rows, size_t cols, Kernel & kernel)
+{
+  parallelScanRows(MatrixView< const T >(mtx, rows, cols), kernel);
+}
+
+template< class T, class Kernel >
+void common::parallelScanRows(const MatrixView< const T > & mtx, Kernel & kernel)
+{
+  const size_t rows = mtx.rows();
+  const size_t cols = mtx.cols();
+  parallelTiles(rows, cols, kernel, [&mtx, rows, cols](Kernel & part, size_t begin, size_t end)
+  {
+    recordTile(mtx.row(begin), (end - begin) * mtx.stride() * sizeof(T));
+    for (size_t i = begin; i < end; ++i)
+    {
+      const T * above = i > 0 ? mtx.row(i - 1) : nullptr;
+      const T * below = i + 1 < rows ? mtx.row(i + 1) : nullptr;
+      part(above, mtx.row(i), below, cols);
+    }
+  });
+}
+
+#endif
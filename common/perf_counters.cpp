@@ -0,0 +1,110 @@
+#include <perf_counters.hpp>
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+  const unsigned long long EVENTS[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+
+  int openCounter(unsigned long long event)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = event;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast< int >(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+#endif
+}
+
+unsigned long long common::CounterValues::get(Counter counter) const
+{
+  return values[static_cast< size_t >(counter)];
+}
+
+bool common::CounterValues::has(Counter counter) const
+{
+  return valid[static_cast< size_t >(counter)];
+}
+
+void common::CounterValues::add(const CounterValues & begin, const CounterValues & end)
+{
+  for (size_t i = 0; i < COUNT; ++i)
+  {
+    valid[i] = begin.valid[i] && end.valid[i];
+    values[i] += valid[i] ? end.values[i] - begin.values[i] : 0;
+  }
+}
+
+common::CounterValues common::noCounters()
+{
+  CounterValues none = { { 0, 0, 0, 0 }, { false, false, false, false } };
+  return none;
+}
+
+common::PerfCounters::PerfCounters()
+{
+  for (size_t i = 0; i < CounterValues::COUNT; ++i)
+  {
+#ifdef __linux__
+    fds_[i] = openCounter(EVENTS[i]);
+#else
+    fds_[i] = -1;
+#endif
+  }
+}
+
+common::PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+  for (size_t i = 0; i < CounterValues::COUNT; ++i)
+  {
+    if (fds_[i] >= 0)
+    {
+      close(fds_[i]);
+    }
+  }
+#endif
+}
+
+bool common::PerfCounters::available() const
+{
+  for (size_t i = 0; i < CounterValues::COUNT; ++i)
+  {
+    if (fds_[i] >= 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+common::CounterValues common::PerfCounters::read() const
+{
+  CounterValues result = noCounters();
+#ifdef __linux__
+  for (size_t i = 0; i < CounterValues::COUNT; ++i)
+  {
+    unsigned long long value = 0;
+    if (fds_[i] >= 0 && ::read(fds_[i], &value, sizeof(value)) == sizeof(value))
+    {
+      result.values[i] = value;
+      result.valid[i] = true;
+    }
+  }
+#endif
+  return result;
+}
@@ -0,0 +1,46 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstddef>
+
+namespace common
+{
+  enum class Counter
+  {
+    cycles,
+    instructions,
+    llc_misses,
+    branch_misses
+  };
+
+  struct CounterValues
+  {
+    static const size_t COUNT = 4;
+
+    unsigned long long values[COUNT];
+    bool valid[COUNT];
+
+    unsigned long long get(Counter counter) const;
+    bool has(Counter counter) const;
+    void add(const CounterValues & begin, const CounterValues & end);
+  };
+
+  class PerfCounters
+  {
+  public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters & operator=(const PerfCounters &) = delete;
+
+    bool available() const;
+    CounterValues read() const;
+
+  private:
+    int fds_[CounterValues::COUNT];
+  };
+
+  CounterValues noCounters();
+}
+
+#endif
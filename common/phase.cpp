@@ -0,0 +1,109 @@
+#include <phase.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <matrix_writer.hpp>
+
+namespace
+{
+  std::mutex & totalsMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  std::vector< common::PhaseTotal > & totals()
+  {
+    static std::vector< common::PhaseTotal > all;
+    return all;
+  }
+}
+
+std::atomic< bool > common::Phase::enabled_(false);
+std::atomic< const common::PerfCounters * > common::Phase::counters_(nullptr);
+
+void common::Phase::enable(bool on)
+{
+  enabled_.store(on, std::memory_order_relaxed);
+}
+
+void common::Phase::attach(const PerfCounters * counters)
+{
+  counters_.store(counters, std::memory_order_relaxed);
+}
+
+std::vector< common::PhaseTotal > common::Phase::collect()
+{
+  std::lock_guard< std::mutex > lock(totalsMutex());
+  std::vector< PhaseTotal > result;
+  result.swap(totals());
+  return result;
+}
+
+void common::Phase::start()
+{
+  const PerfCounters * counters = counters_.load(std::memory_order_relaxed);
+  begin_ = counters ? counters->read() : noCounters();
+  start_ = clock::now();
+}
+
+void common::Phase::finish()
+{
+  const clock::duration elapsed = clock::now() - start_;
+  const unsigned long long ns = std::chrono::duration_cast< std::chrono::nanoseconds >(elapsed).count();
+  const PerfCounters * counters = counters_.load(std::memory_order_relaxed);
+  const CounterValues end = counters ? counters->read() : noCounters();
+  std::lock_guard< std::mutex > lock(totalsMutex());
+  std::vector< PhaseTotal > & all = totals();
+  for (size_t i = 0; i < all.size(); ++i)
+  {
+    if (all[i].name == name_)
+    {
+      ++all[i].calls;
+      all[i].nanoseconds += ns;
+      all[i].cells += cells_;
+      all[i].bytes += bytes_;
+      all[i].counters.add(begin_, end);
+      return;
+    }
+  }
+  PhaseTotal total = { name_, 1, ns, cells_, bytes_, noCounters() };
+  total.counters.add(begin_, end);
+  all.push_back(total);
+}
+
+bool common::phaseSummary()
+{
+  const char * value = std::getenv("MATRIX_PHASES");
+  return value && *value && std::strcmp(value, "0") != 0;
+}
+
+void common::printPhases(std::ostream & out, const std::vector< PhaseTotal > & totals)
+{
+  BufferedWriter writer(out);
+  writer << "phase calls ms cells bytes ns/cell MB/s\n";
+  for (const PhaseTotal & total : totals)
+  {
+    const double ns = static_cast< double >(total.nanoseconds);
+    writer << total.name.c_str() << ' ' << total.calls << ' ' << ns / 1e6 << ' ' << static_cast< size_t >(total.cells) << ' ';
+    writer << static_cast< size_t >(total.bytes) << ' ';
+    if (total.cells)
+    {
+      writer << ns / static_cast< double >(total.cells);
+    }
+    else
+    {
+      writer << '-';
+    }
+    writer << ' ';
+    if (total.bytes && total.nanoseconds)
+    {
+      writer << static_cast< double >(total.bytes) * 1e3 / ns;
+    }
+    else
+    {
+      writer << '-';
+    }
+    writer << '\n';
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef PHASE_HPP
+#define PHASE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <perf_counters.hpp>
+
+namespace common
+{
+  struct PhaseTotal
+  {
+    std::string name;
+    size_t calls;
+    unsigned long long nanoseconds;
+    unsigned long long cells;
+    unsigned long long bytes;
+    CounterValues counters;
+  };
+
+  class Phase
+  {
+  public:
+    Phase(const char * name, size_t cells);
+    ~Phase();
+    Phase(const Phase &) = delete;
+    Phase & operator=(const Phase &) = delete;
+
+    void addBytes(size_t bytes);
+
+    static bool enabled();
+    static void enable(bool on);
+    static void attach(const PerfCounters * counters);
+    static std::vector< PhaseTotal > collect();
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    static std::atomic< bool > enabled_;
+    static std::atomic< const PerfCounters * > counters_;
+
+    const char * name_;
+    size_t cells_;
+    size_t bytes_;
+    bool active_;
+    clock::time_point start_;
+    CounterValues begin_;
+
+    void start();
+    void finish();
+  };
+
+  bool phaseSummary();
+  void printPhases(std::ostream & out, const std::vector< PhaseTotal > & totals);
+}
+
+inline common::Phase::Phase(const char * name, size_t cells):
+  name_(name),
+  cells_(cells),
+  bytes_(0),
+  active_(enabled()),
+  start_(),
+  begin_()
+{
+  if (active_)
+  {
+    start();
+  }
+}
+
+inline common::Phase::~Phase()
+{
+  if (active_)
+  {
+    finish();
+  }
+}
+
+inline void common::Phase::addBytes(size_t bytes)
+{
+  bytes_ += bytes;
+}
+
+inline bool common::Phase::enabled()
+{
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,17 @@
+#include <pipeline.hpp>
+
+namespace
+{
+  const size_t BLOCK_CELLS = 1 << 16;
+  const size_t MIN_PIPELINE_CELLS = 1 << 18;
+}
+
+size_t common::pipelineBlockRows(size_t cols)
+{
+  return cols < BLOCK_CELLS ? BLOCK_CELLS / cols : 1;
+}
+
+bool common::pipelineEnabled(size_t rows, size_t cols)
+{
+  return threadCount() > 1 && rows * cols >= MIN_PIPELINE_CELLS;
+}
@@ -0,0 +1,194 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <istream>
+#include <thread>
+#include <vector>
+#include <matrix_reader.hpp>
+#include <parallel.hpp>
+#include <phase.hpp>
+
+namespace common
+{
+  template< class T >
+  class SpscQueue
+  {
+  public:
+    explicit SpscQueue(size_t capacity);
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue & operator=(const SpscQueue &) = delete;
+
+    bool push(const T & value);
+    bool pop(T & value);
+    void waitPush(const T & value);
+    void waitPop(T & value);
+
+  private:
+    std::vector< T > slots_;
+    size_t mask_;
+    alignas(64) std::atomic< size_t > head_;
+    alignas(64) std::atomic< size_t > tail_;
+  };
+
+  struct RowBlock
+  {
+    size_t begin;
+    size_t end;
+  };
+
+  size_t pipelineBlockRows(size_t cols);
+  bool pipelineEnabled(size_t rows, size_t cols);
+
+  template< class T, class Transform, class Emit >
+  size_t pipelineRows(std::istream & input, T * mtx, size_t rows, size_t cols, Transform & transform, Emit & emit);
+}
+
+template< class T >
+common::SpscQueue< T >::SpscQueue(size_t capacity):
+  slots_(),
+  mask_(0),
+  head_(0),
+  tail_(0)
+{
+  size_t size = 1;
+  while (size < capacity)
+  {
+    size *= 2;
+  }
+  slots_.resize(size);
+  mask_ = size - 1;
+}
+
+template< class T >
+bool common::SpscQueue< T >::push(const T & value)
+{
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+  {
+    return false;
+  }
+  slots_[tail & mask_] = value;
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template< class T >
+bool common::SpscQueue< T >::pop(T & value)
+{
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+  value = slots_[head & mask_];
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template< class T >
+void common::SpscQueue< T >::waitPush(const T & value)
+{
+  while (!push(value))
+  {
+    std::this_thread::yield();
+  }
+}
+
+template< class T >
+void common::SpscQueue< T >::waitPop(T & value)
+{
+  while (!pop(value))
+  {
+    std::this_thread::yield();
+  }
+}
+
+template< class T, class Transform, class Emit >
+size_t common::pipelineRows(std::istream & input, T * mtx, size_t rows, size_t cols, Transform & transform,
+    Emit & emit)
+{
+  if (rows == 0 || cols == 0)
+  {
+    return 0;
+  }
+  Phase phase("pipeline", rows * cols);
+  StreamReader reader(input);
+  const size_t block = pipelineBlockRows(cols);
+  size_t done = 0;
+  if (!pipelineEnabled(rows, cols))
+  {
+    for (size_t begin = 0; begin < rows; begin += block)
+    {
+      const size_t end = begin + block < rows ? begin + block : rows;
+      const size_t got = reader.read(mtx + begin * cols, (end - begin) * cols);
+      done += got;
+      const size_t complete = begin + got / cols;
+      if (complete != begin)
+      {
+        transform(mtx, begin, complete);
+        emit(mtx + begin * cols, (complete - begin) * cols);
+      }
+      if (complete != end)
+      {
+        break;
+      }
+    }
+    phase.addBytes(reader.consumed());
+    return done;
+  }
+  const size_t QUEUE_BLOCKS = 8;
+  SpscQueue< RowBlock > parsed(QUEUE_BLOCKS);
+  SpscQueue< RowBlock > transformed(QUEUE_BLOCKS);
+  std::thread compute([&]()
+  {
+    RowBlock rows_block = { 0, 0 };
+    do
+    {
+      parsed.waitPop(rows_block);
+      if (rows_block.begin != rows_block.end)
+      {
+        transform(mtx, rows_block.begin, rows_block.end);
+      }
+      transformed.waitPush(rows_block);
+    }
+    while (rows_block.begin != rows_block.end);
+  });
+  std::thread write([&]()
+  {
+    RowBlock rows_block = { 0, 0 };
+    do
+    {
+      transformed.waitPop(rows_block);
+      if (rows_block.begin != rows_block.end)
+      {
+        emit(mtx + rows_block.begin * cols, (rows_block.end - rows_block.begin) * cols);
+      }
+    }
+    while (rows_block.begin != rows_block.end);
+  });
+  for (size_t begin = 0; begin < rows; begin += block)
+  {
+    const size_t end = begin + block < rows ? begin + block : rows;
+    const size_t got = reader.read(mtx + begin * cols, (end - begin) * cols);
+    done += got;
+    const RowBlock complete = { begin, begin + got / cols };
+    if (complete.begin != complete.end)
+    {
+      parsed.waitPush(complete);
+    }
+    if (complete.end != end)
+    {
+      break;
+    }
+  }
+  const RowBlock finish = { rows, rows };
+  parsed.waitPush(finish);
+  compute.join();
+  write.join();
+  phase.addBytes(reader.consumed());
+  return done;
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include <result_cache.hpp>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <mapped_file.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+
+  uint64_t mix(uint64_t value)
+  {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ULL;
+    value ^= value >> 33;
+    return value;
+  }
+
+  std::string hex(uint64_t value)
+  {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast< unsigned long long >(value));
+    return text;
+  }
+
+  const char * cacheDirectory()
+  {
+    const char * value = std::getenv("MATRIX_CACHE");
+    return value && *value ? value : nullptr;
+  }
+
+  bool fileHash(const char * path, uint64_t & hash)
+  {
+    common::MappedFile file;
+    if (!file.open(path))
+    {
+      return false;
+    }
+    hash = common::contentHash(file.data(), file.size());
+    return true;
+  }
+
+  const std::string & programVersion()
+  {
+    static const std::string version = []()
+    {
+      uint64_t hash = 0;
+      return fileHash("/proc/self/exe", hash) ? hex(hash) : std::string();
+    }();
+    return version;
+  }
+
+  bool plainName(const char * text)
+  {
+    for (const char * c = text; *c; ++c)
+    {
+      if (!std::isalnum(static_cast< unsigned char >(*c)))
+      {
+        return false;
+      }
+    }
+    return *text != '\0';
+  }
+
+  bool copyFile(const std::string & from, const std::string & to)
+  {
+    std::ifstream input(from, std::ios::binary);
+    std::ofstream output(to, std::ios::binary);
+    if (!input || !output)
+    {
+      return false;
+    }
+    if (input.peek() != std::ifstream::traits_type::eof())
+    {
+      output << input.rdbuf();
+    }
+    output.close();
+    return static_cast< bool >(output);
+  }
+
+  bool readable(const std::string & path)
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    return access(path.c_str(), R_OK) == 0;
+#else
+    return static_cast< bool >(std::ifstream(path, std::ios::binary));
+#endif
+  }
+
+  bool temporaryFile(const std::string & entry, std::string & temporary)
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    temporary = entry + ".XXXXXX";
+    const int fd = mkstemp(&temporary[0]);
+    if (fd < 0)
+    {
+      return false;
+    }
+    close(fd);
+    return true;
+#else
+    temporary = entry + ".tmp";
+    return true;
+#endif
+  }
+
+  void storeResult(const std::string & output, const std::string & entry)
+  {
+    std::string temporary;
+    if (!temporaryFile(entry, temporary))
+    {
+      return;
+    }
+    if (!copyFile(output, temporary) || std::rename(temporary.c_str(), entry.c_str()) != 0)
+    {
+      std::remove(temporary.c_str());
+    }
+  }
+}
+
+uint64_t common::contentHash(const char * data, size_t size)
+{
+  uint64_t hash = mix(size ^ MULTIPLIER);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ mix(word)) * MULTIPLIER;
+    hash = hash << 29 | hash >> 35;
+  }
+  uint64_t tail = 0;
+  for (size_t shift = 0; i < size; ++i, shift += 8)
+  {
+    tail |= static_cast< uint64_t >(static_cast< unsigned char >(data[i])) << shift;
+  }
+  return mix(hash ^ mix(tail));
+}
+
+int common::runCached(int argc, char ** argv, Job job)
+{
+  const char * dir = cacheDirectory();
+  uint64_t input = 0;
+  if (!dir || argc != 4 || !plainName(argv[1]) || programVersion().empty() || !fileHash(argv[2], input))
+  {
+    return job(argc, argv);
+  }
+  const std::string entry = std::string(dir) + '/' + programVersion() + '.' + argv[1] + '.' + hex(input);
+  if (readable(entry) && copyFile(entry, argv[3]))
+  {
+    return 0;
+  }
+  const int code = job(argc, argv);
+  if (code == 0)
+  {
+    storeResult(argv[3], entry);
+  }
+  return code;
+}
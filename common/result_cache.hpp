@@ -0,0 +1,14 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <batch.hpp>
+
+namespace common
+{
+  uint64_t contentHash(const char * data, size_t size);
+  int runCached(int argc, char ** argv, Job job);
+}
+
+#endif
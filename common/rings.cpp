@@ -0,0 +1,22 @@
+#include <rings.hpp>
+#include <algorithm>
+#include <simd_kernels.hpp>
+
+size_t common::ringDepth(size_t rows, size_t cols, size_t row, size_t col)
+{
+  return std::min(std::min(row, rows - 1 - row), std::min(col, cols - 1 - col));
+}
+
+void common::ringSteps(size_t rows, size_t cols, size_t row, int * steps)
+{
+  const size_t outer = std::min(row, rows - 1 - row);
+  for (size_t j = 0; j < cols; ++j)
+  {
+    steps[j] = static_cast< int >(std::min(outer, std::min(j, cols - 1 - j)) + 1);
+  }
+}
+
+bool common::addStepsChecked(int * values, const int * steps, size_t count)
+{
+  return simd::kernels().add_steps(values, steps, count);
+}
@@ -0,0 +1,13 @@
+#ifndef RINGS_HPP
+#define RINGS_HPP
+
+#include <cstddef>
+
+namespace common
+{
+  size_t ringDepth(size_t rows, size_t cols, size_t row, size_t col);
+  void ringSteps(size_t rows, size_t cols, size_t row, int * steps);
+  bool addStepsChecked(int * values, const int * steps, size_t count);
+}
+
+#endif
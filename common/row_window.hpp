@@ -0,0 +1,119 @@
+#ifndef ROW_WINDOW_HPP
+#define ROW_WINDOW_HPP
+
+#include <cstddef>
+#include <istream>
+#include <matrix_reader.hpp>
+#include <phase.hpp>
+
+namespace common
+{
+  template< class T >
+  class RowWindow
+  {
+  public:
+    explicit RowWindow(size_t cols);
+    ~RowWindow();
+    RowWindow(const RowWindow &) = delete;
+    RowWindow & operator=(const RowWindow &) = delete;
+
+    size_t cols() const;
+    T * back();
+    void push();
+    const T * row(size_t age) const;
+
+  private:
+    static const size_t DEPTH = 3;
+
+    T * storage_;
+    size_t cols_;
+    size_t head_;
+  };
+
+  template< class T, class Kernel >
+  void scanRows(const T * mtx, size_t rows, size_t cols, Kernel & kernel);
+  template< class T, class Kernel >
+  size_t streamRows(std::istream & input, size_t rows, size_t cols, Kernel & kernel);
+}
+
+template< class T >
+common::RowWindow< T >::RowWindow(size_t cols):
+  storage_(new T[DEPTH * cols]),
+  cols_(cols),
+  head_(0)
+{}
+
+template< class T >
+common::RowWindow< T >::~RowWindow()
+{
+  delete[] storage_;
+}
+
+template< class T >
+size_t common::RowWindow< T >::cols() const
+{
+  return cols_;
+}
+
+template< class T >
+T * common::RowWindow< T >::back()
+{
+  return storage_ + (head_ + 1) % DEPTH * cols_;
+}
+
+template< class T >
+void common::RowWindow< T >::push()
+{
+  head_ = (head_ + 1) % DEPTH;
+}
+
+template< class T >
+const T * common::RowWindow< T >::row(size_t age) const
+{
+  return storage_ + (head_ + DEPTH - age) % DEPTH * cols_;
+}
+
+template< class T, class Kernel >
+void common::scanRows(const T * mtx, size_t rows, size_t cols, Kernel & kernel)
+{
+  for (size_t i = 0; i < rows; ++i)
+  {
+    const T * above = i > 0 ? mtx + (i - 1) * cols : nullptr;
+    const T * below = i + 1 < rows ? mtx + (i + 1) * cols : nullptr;
+    kernel(above, mtx + i * cols, below, cols);
+  }
+}
+
+template< class T, class Kernel >
+size_t common::streamRows(std::istream & input, size_t rows, size_t cols, Kernel & kernel)
+{
+  if (rows == 0 || cols == 0)
+  {
+    return 0;
+  }
+  Phase phase("stream", rows * cols);
+  RowWindow< T > window(cols);
+  StreamReader reader(input);
+  size_t done = 0;
+  for (size_t i = 0; i < rows; ++i)
+  {
+    const size_t got = reader.read(window.back(), cols);
+    done += got;
+    if (got != cols)
+    {
+      phase.addBytes(reader.consumed());
+      return done;
+    }
+    window.push();
+    if (i > 0)
+    {
+      kernel(i > 1 ? window.row(2) : nullptr, window.row(1), window.row(0), cols);
+    }
+  }
+  const T * none = nullptr;
+  kernel(rows > 1 ? window.row(1) : none, window.row(0), none, cols);
+  phase.addBytes(reader.consumed());
+  return done;
+}
+
+#endif
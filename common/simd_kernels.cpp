@@ -0,0 +1,50 @@
+#include <simd_kernels.hpp>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+  const size_t MAX_VARIANTS = 4;
+
+  size_t supportedKernels(const common::simd::Kernels ** variants)
+  {
+    size_t count = 0;
+#ifdef COMMON_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+      variants[count++] = &common::simd::avx2::kernelTable();
+    }
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+      variants[count++] = &common::simd::sse42::kernelTable();
+    }
+#endif
+    variants[count++] = &common::simd::kernelTable();
+#if defined(__SSE2__)
+    variants[count++] = &common::simd::scalar::kernelTable();
+#endif
+    return count;
+  }
+
+  const common::simd::Kernels & selectKernels()
+  {
+    const common::simd::Kernels * variants[MAX_VARIANTS] = {};
+    const size_t count = supportedKernels(variants);
+    const char * value = std::getenv("MATRIX_SIMD");
+    for (size_t i = 0; value && *value && i < count; ++i)
+    {
+      if (std::strcmp(value, variants[i]->isa) == 0)
+      {
+        return *variants[i];
+      }
+    }
+    return *variants[0];
+  }
+}
+
+const common::simd::Kernels & common::simd::kernels()
+{
+  static const Kernels & selected = selectKernels();
+  return selected;
+}
@@ -0,0 +1,87 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <simd_lanes.hpp>
+
+namespace common
+{
+  namespace simd
+  {
+    const size_t EXTREMUM_TESTS = 4;
+    const size_t EXTREMUM_SHAPES = 2;
+
+    template< class T >
+    struct TypeKernels
+    {
+      using ExtremaKernel = size_t (*)(const T * const * rows, size_t from, size_t end);
+
+      size_t width;
+      ExtremaKernel extrema[EXTREMUM_TESTS][EXTREMUM_SHAPES];
+      size_t (*next_nonzero)(const T * values, size_t from, size_t to);
+      uint64_t (*equal_mask)(const T * row, const T * below, size_t from, size_t to);
+    };
+
+    struct Kernels
+    {
+      const char * isa;
+      TypeKernels< std::int8_t > int8;
+      TypeKernels< std::int16_t > int16;
+      TypeKernels< int > int32;
+      TypeKernels< long long > int64;
+      void (*column_runs)(const int * row, const int * below, size_t cols, int * run, int * best);
+      bool (*add_steps)(int * values, const int * steps, size_t count);
+    };
+
+    const Kernels & kernels();
+    template< class T >
+    const TypeKernels< T > & kernelsFor();
+
+    namespace scalar
+    {
+      const Kernels & kernelTable();
+    }
+
+    namespace sse2
+    {
+      const Kernels & kernelTable();
+    }
+
+    namespace sse42
+    {
+      const Kernels & kernelTable();
+    }
+
+    namespace avx2
+    {
+      const Kernels & kernelTable();
+    }
+  }
+}
+
+template<>
+inline const common::simd::TypeKernels< std::int8_t > & common::simd::kernelsFor< std::int8_t >()
+{
+  return kernels().int8;
+}
+
+template<>
+inline const common::simd::TypeKernels< std::int16_t > & common::simd::kernelsFor< std::int16_t >()
+{
+  return kernels().int16;
+}
+
+template<>
+inline const common::simd::TypeKernels< int > & common::simd::kernelsFor< int >()
+{
+  return kernels().int32;
+}
+
+template<>
+inline const common::simd::TypeKernels< long long > & common::simd::kernelsFor< long long >()
+{
+  return kernels().int64;
+}
+
+#endif
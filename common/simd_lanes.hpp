@@ -0,0 +1,611 @@
+#ifndef SIMD_LANES_HPP
+#define SIMD_LANES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace common
+{
+  namespace simd
+  {
+#if defined(__AVX2__)
+    inline namespace avx2
+#elif defined(__SSE4_2__)
+    inline namespace sse42
+#elif defined(__SSE2__)
+    inline namespace sse2
+#else
+    inline namespace scalar
+#endif
+    {
+      template< class T >
+      struct ScalarLanes
+      {
+        using value_type = T;
+        using vector = T;
+        static const size_t width = 1;
+
+        static vector load(const T * p)
+        {
+          return *p;
+        }
+        static void store(T * p, vector v)
+        {
+          *p = v;
+        }
+        static vector splat(T v)
+        {
+          return v;
+        }
+        static vector add(vector a, vector b)
+        {
+          return a + b;
+        }
+        static vector sub(vector a, vector b)
+        {
+          return a - b;
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return mask ? a : b;
+        }
+        static vector greater(vector a, vector b)
+        {
+          return a > b;
+        }
+        static vector equal(vector a, vector b)
+        {
+          return a == b;
+        }
+        static vector both(vector a, vector b)
+        {
+          return a & b;
+        }
+        static vector ones()
+        {
+          return 1;
+        }
+        static vector flip(vector a)
+        {
+          return a ^ 1;
+        }
+        static unsigned bits(vector mask)
+        {
+          return static_cast< unsigned >(mask);
+        }
+        static size_t count(vector mask)
+        {
+          return static_cast< size_t >(mask);
+        }
+      };
+
+#if defined(__AVX2__)
+      struct Int32Lanes
+      {
+        using value_type = int;
+        using vector = __m256i;
+        static const size_t width = 8;
+
+        static vector load(const int * p)
+        {
+          return _mm256_loadu_si256(reinterpret_cast< const __m256i * >(p));
+        }
+        static void store(int * p, vector v)
+        {
+          _mm256_storeu_si256(reinterpret_cast< __m256i * >(p), v);
+        }
+        static vector splat(int v)
+        {
+          return _mm256_set1_epi32(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm256_add_epi32(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm256_sub_epi32(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm256_blendv_epi8(b, a, mask);
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm256_cmpgt_epi32(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm256_cmpeq_epi32(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm256_and_si256(a, b);
+        }
+        static vector ones()
+        {
+          return _mm256_set1_epi32(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm256_xor_si256(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+
+      struct Int64Lanes
+      {
+        using value_type = long long;
+        using vector = __m256i;
+        static const size_t width = 4;
+
+        static vector load(const long long * p)
+        {
+          return _mm256_loadu_si256(reinterpret_cast< const __m256i * >(p));
+        }
+        static void store(long long * p, vector v)
+        {
+          _mm256_storeu_si256(reinterpret_cast< __m256i * >(p), v);
+        }
+        static vector splat(long long v)
+        {
+          return _mm256_set1_epi64x(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm256_add_epi64(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm256_sub_epi64(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm256_blendv_epi8(b, a, mask);
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm256_cmpgt_epi64(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm256_cmpeq_epi64(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm256_and_si256(a, b);
+        }
+        static vector ones()
+        {
+          return _mm256_set1_epi64x(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm256_xor_si256(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return _mm256_movemask_pd(_mm256_castsi256_pd(mask));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+
+      struct Int8Lanes
+      {
+        using value_type = std::int8_t;
+        using vector = __m256i;
+        static const size_t width = 32;
+
+        static vector load(const std::int8_t * p)
+        {
+          return _mm256_loadu_si256(reinterpret_cast< const __m256i * >(p));
+        }
+        static void store(std::int8_t * p, vector v)
+        {
+          _mm256_storeu_si256(reinterpret_cast< __m256i * >(p), v);
+        }
+        static vector splat(std::int8_t v)
+        {
+          return _mm256_set1_epi8(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm256_add_epi8(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm256_sub_epi8(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm256_blendv_epi8(b, a, mask);
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm256_cmpgt_epi8(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm256_cmpeq_epi8(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm256_and_si256(a, b);
+        }
+        static vector ones()
+        {
+          return _mm256_set1_epi8(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm256_xor_si256(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return static_cast< unsigned >(_mm256_movemask_epi8(mask));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+
+      struct Int16Lanes
+      {
+        using value_type = std::int16_t;
+        using vector = __m256i;
+        static const size_t width = 16;
+
+        static vector load(const std::int16_t * p)
+        {
+          return _mm256_loadu_si256(reinterpret_cast< const __m256i * >(p));
+        }
+        static void store(std::int16_t * p, vector v)
+        {
+          _mm256_storeu_si256(reinterpret_cast< __m256i * >(p), v);
+        }
+        static vector splat(std::int16_t v)
+        {
+          return _mm256_set1_epi16(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm256_add_epi16(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm256_sub_epi16(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm256_blendv_epi8(b, a, mask);
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm256_cmpgt_epi16(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm256_cmpeq_epi16(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm256_and_si256(a, b);
+        }
+        static vector ones()
+        {
+          return _mm256_set1_epi16(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm256_xor_si256(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          const __m128i packed = _mm_packs_epi16(_mm256_castsi256_si128(mask), _mm256_extracti128_si256(mask, 1));
+          return static_cast< unsigned >(_mm_movemask_epi8(packed));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+#elif defined(__SSE2__)
+      struct Int32Lanes
+      {
+        using value_type = int;
+        using vector = __m128i;
+        static const size_t width = 4;
+
+        static vector load(const int * p)
+        {
+          return _mm_loadu_si128(reinterpret_cast< const __m128i * >(p));
+        }
+        static void store(int * p, vector v)
+        {
+          _mm_storeu_si128(reinterpret_cast< __m128i * >(p), v);
+        }
+        static vector splat(int v)
+        {
+          return _mm_set1_epi32(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm_add_epi32(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm_sub_epi32(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm_cmpgt_epi32(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm_cmpeq_epi32(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm_and_si128(a, b);
+        }
+        static vector ones()
+        {
+          return _mm_set1_epi32(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm_xor_si128(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return _mm_movemask_ps(_mm_castsi128_ps(mask));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+
+      struct Int8Lanes
+      {
+        using value_type = std::int8_t;
+        using vector = __m128i;
+        static const size_t width = 16;
+
+        static vector load(const std::int8_t * p)
+        {
+          return _mm_loadu_si128(reinterpret_cast< const __m128i * >(p));
+        }
+        static void store(std::int8_t * p, vector v)
+        {
+          _mm_storeu_si128(reinterpret_cast< __m128i * >(p), v);
+        }
+        static vector splat(std::int8_t v)
+        {
+          return _mm_set1_epi8(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm_add_epi8(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm_sub_epi8(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm_cmpgt_epi8(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm_cmpeq_epi8(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm_and_si128(a, b);
+        }
+        static vector ones()
+        {
+          return _mm_set1_epi8(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm_xor_si128(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return static_cast< unsigned >(_mm_movemask_epi8(mask));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+
+      struct Int16Lanes
+      {
+        using value_type = std::int16_t;
+        using vector = __m128i;
+        static const size_t width = 8;
+
+        static vector load(const std::int16_t * p)
+        {
+          return _mm_loadu_si128(reinterpret_cast< const __m128i * >(p));
+        }
+        static void store(std::int16_t * p, vector v)
+        {
+          _mm_storeu_si128(reinterpret_cast< __m128i * >(p), v);
+        }
+        static vector splat(std::int16_t v)
+        {
+          return _mm_set1_epi16(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm_add_epi16(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm_sub_epi16(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm_cmpgt_epi16(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm_cmpeq_epi16(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm_and_si128(a, b);
+        }
+        static vector ones()
+        {
+          return _mm_set1_epi16(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm_xor_si128(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return static_cast< unsigned >(_mm_movemask_epi8(_mm_packs_epi16(mask, _mm_setzero_si128())));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+
+#if defined(__SSE4_2__)
+      struct Int64Lanes
+      {
+        using value_type = long long;
+        using vector = __m128i;
+        static const size_t width = 2;
+
+        static vector load(const long long * p)
+        {
+          return _mm_loadu_si128(reinterpret_cast< const __m128i * >(p));
+        }
+        static void store(long long * p, vector v)
+        {
+          _mm_storeu_si128(reinterpret_cast< __m128i * >(p), v);
+        }
+        static vector splat(long long v)
+        {
+          return _mm_set1_epi64x(v);
+        }
+        static vector add(vector a, vector b)
+        {
+          return _mm_add_epi64(a, b);
+        }
+        static vector sub(vector a, vector b)
+        {
+          return _mm_sub_epi64(a, b);
+        }
+        static vector select(vector mask, vector a, vector b)
+        {
+          return _mm_blendv_epi8(b, a, mask);
+        }
+        static vector greater(vector a, vector b)
+        {
+          return _mm_cmpgt_epi64(a, b);
+        }
+        static vector equal(vector a, vector b)
+        {
+          return _mm_cmpeq_epi64(a, b);
+        }
+        static vector both(vector a, vector b)
+        {
+          return _mm_and_si128(a, b);
+        }
+        static vector ones()
+        {
+          return _mm_set1_epi32(-1);
+        }
+        static vector flip(vector a)
+        {
+          return _mm_xor_si128(a, ones());
+        }
+        static unsigned bits(vector mask)
+        {
+          return _mm_movemask_pd(_mm_castsi128_pd(mask));
+        }
+        static size_t count(vector mask)
+        {
+          return __builtin_popcount(bits(mask));
+        }
+      };
+#else
+      using Int64Lanes = ScalarLanes< long long >;
+#endif
+#else
+      using Int8Lanes = ScalarLanes< std::int8_t >;
+      using Int16Lanes = ScalarLanes< std::int16_t >;
+      using Int32Lanes = ScalarLanes< int >;
+      using Int64Lanes = ScalarLanes< long long >;
+#endif
+
+      template< class T >
+      struct Lanes;
+
+      template<>
+      struct Lanes< std::int8_t >
+      {
+        using type = Int8Lanes;
+      };
+
+      template<>
+      struct Lanes< std::int16_t >
+      {
+        using type = Int16Lanes;
+      };
+
+      template<>
+      struct Lanes< int >
+      {
+        using type = Int32Lanes;
+      };
+
+      template<>
+      struct Lanes< long long >
+      {
+        using type = Int64Lanes;
+      };
+    }
+  }
+}
+
+#endif
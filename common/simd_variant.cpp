@@ -0,0 +1,258 @@
+#include <simd_kernels.hpp>
+#include <limits>
+
+namespace
+{
+  using common::simd::ScalarLanes;
+
+  template< class T >
+  using NativeLanes = typename common::simd::Lanes< T >::type;
+
+#if defined(__AVX2__)
+  const char * const NATIVE_ISA = "avx2";
+#elif defined(__SSE4_2__)
+  const char * const NATIVE_ISA = "sse4.2";
+#elif defined(__SSE2__)
+  const char * const NATIVE_ISA = "sse2";
+#else
+  const char * const NATIVE_ISA = "scalar";
+#endif
+
+  const size_t STRICT_MAX = 0;
+  const size_t STRICT_MIN = 1;
+  const size_t WEAK_MAX = 2;
+  const size_t WEAK_MIN = 3;
+  const size_t CROSS = 0;
+  const size_t SQUARE = 1;
+
+  template< size_t Test >
+  struct Comparison;
+
+  template<>
+  struct Comparison< STRICT_MAX >
+  {
+    template< class L >
+    static typename L::vector test(typename L::vector center, typename L::vector near)
+    {
+      return L::greater(center, near);
+    }
+  };
+
+  template<>
+  struct Comparison< STRICT_MIN >
+  {
+    template< class L >
+    static typename L::vector test(typename L::vector center, typename L::vector near)
+    {
+      return L::greater(near, center);
+    }
+  };
+
+  template<>
+  struct Comparison< WEAK_MAX >
+  {
+    template< class L >
+    static typename L::vector test(typename L::vector center, typename L::vector near)
+    {
+      return L::flip(L::greater(near, center));
+    }
+  };
+
+  template<>
+  struct Comparison< WEAK_MIN >
+  {
+    template< class L >
+    static typename L::vector test(typename L::vector center, typename L::vector near)
+    {
+      return L::flip(L::greater(center, near));
+    }
+  };
+
+  template< size_t Shape >
+  struct Neighbours;
+
+  template<>
+  struct Neighbours< CROSS >
+  {
+    static const size_t size = 4;
+    static const size_t row[size];
+    static const int col[size];
+  };
+
+  const size_t Neighbours< CROSS >::row[] = { 0, 1, 1, 2 };
+  const int Neighbours< CROSS >::col[] = { 0, -1, 1, 0 };
+
+  template<>
+  struct Neighbours< SQUARE >
+  {
+    static const size_t size = 8;
+    static const size_t row[size];
+    static const int col[size];
+  };
+
+  const size_t Neighbours< SQUARE >::row[] = { 0, 0, 0, 1, 1, 2, 2, 2 };
+  const int Neighbours< SQUARE >::col[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+  template< class L, size_t Test, size_t Shape >
+  size_t countLanes(const typename L::value_type * const * rows, size_t from, size_t end, size_t & count)
+  {
+    using vector = typename L::vector;
+    using around = Neighbours< Shape >;
+    size_t j = from;
+    for (; j + L::width <= end; j += L::width)
+    {
+      const vector center = L::load(rows[1] + j);
+      vector hits = L::ones();
+      for (size_t k = 0; k < around::size; ++k)
+      {
+        const vector near = L::load(rows[around::row[k]] + j + around::col[k]);
+        hits = L::both(hits, Comparison< Test >::template test< L >(center, near));
+      }
+      count += L::count(hits);
+    }
+    return j;
+  }
+
+  template< class L, size_t Test, size_t Shape >
+  size_t countExtrema(const typename L::value_type * const * rows, size_t from, size_t end)
+  {
+    size_t count = 0;
+    const size_t j = countLanes< L, Test, Shape >(rows, from, end, count);
+    countLanes< ScalarLanes< typename L::value_type >, Test, Shape >(rows, j, end, count);
+    return count;
+  }
+
+  template< class L >
+  size_t findNonzero(const typename L::value_type * values, size_t from, size_t to)
+  {
+    const unsigned full = L::bits(L::ones());
+    const typename L::vector zero = L::splat(0);
+    size_t j = from;
+    for (; j + L::width <= to; j += L::width)
+    {
+      const unsigned zeros = L::bits(L::equal(L::load(values + j), zero));
+      if (zeros != full)
+      {
+        return j + __builtin_ctz(~zeros & full);
+      }
+    }
+    while (j < to && values[j] == 0)
+    {
+      ++j;
+    }
+    return j;
+  }
+
+  template< class L >
+  uint64_t equalMask(const typename L::value_type * row, const typename L::value_type * below, size_t from,
+      size_t to)
+  {
+    uint64_t equal = 0;
+    size_t j = from;
+    for (; j + L::width <= to; j += L::width)
+    {
+      const uint64_t bits = L::bits(L::equal(L::load(row + j), L::load(below + j)));
+      equal |= bits << (j - from);
+    }
+    for (; j < to; ++j)
+    {
+      equal |= uint64_t(row[j] == below[j]) << (j - from);
+    }
+    return equal;
+  }
+
+  template< class L >
+  void columnRuns(const int * row, const int * below, size_t cols, int * run, int * best)
+  {
+    using vector = typename L::vector;
+    const vector one = L::splat(1);
+    const vector zero = L::splat(0);
+    size_t j = 0;
+    for (; j + L::width <= cols; j += L::width)
+    {
+      const vector equal = L::equal(L::load(row + j), L::load(below + j));
+      const vector length = L::select(equal, L::add(L::load(run + j), one), zero);
+      const vector top = L::load(best + j);
+      L::store(run + j, length);
+      L::store(best + j, L::select(L::greater(length, top), length, top));
+    }
+    for (; j < cols; ++j)
+    {
+      run[j] = row[j] == below[j] ? run[j] + 1 : 0;
+      best[j] = run[j] > best[j] ? run[j] : best[j];
+    }
+  }
+
+  template< class L >
+  bool addSteps(int * values, const int * steps, size_t count)
+  {
+    constexpr int top = std::numeric_limits< int >::max();
+    typename L::vector wrapped = L::splat(0);
+    size_t j = 0;
+    for (; j + L::width <= count; j += L::width)
+    {
+      const typename L::vector value = L::load(values + j);
+      const typename L::vector sum = L::add(value, L::load(steps + j));
+      wrapped = L::select(L::greater(value, sum), L::ones(), wrapped);
+      L::store(values + j, sum);
+    }
+    bool overflow = L::bits(wrapped) != 0;
+    for (; j < count; ++j)
+    {
+      if (values[j] > top - steps[j])
+      {
+        overflow = true;
+        continue;
+      }
+      values[j] += steps[j];
+    }
+    return !overflow;
+  }
+
+  template< template< class > class LanesOf, class T >
+  common::simd::TypeKernels< T > typeKernels()
+  {
+    using L = LanesOf< T >;
+    const common::simd::TypeKernels< T > kernels = {
+      L::width,
+      {
+        { countExtrema< L, STRICT_MAX, CROSS >, countExtrema< L, STRICT_MAX, SQUARE > },
+        { countExtrema< L, STRICT_MIN, CROSS >, countExtrema< L, STRICT_MIN, SQUARE > },
+        { countExtrema< L, WEAK_MAX, CROSS >, countExtrema< L, WEAK_MAX, SQUARE > },
+        { countExtrema< L, WEAK_MIN, CROSS >, countExtrema< L, WEAK_MIN, SQUARE > }
+      },
+      findNonzero< L >,
+      equalMask< L >
+    };
+    return kernels;
+  }
+
+  template< template< class > class LanesOf >
+  common::simd::Kernels makeKernels(const char * isa)
+  {
+    const common::simd::Kernels kernels = {
+      isa,
+      typeKernels< LanesOf, std::int8_t >(),
+      typeKernels< LanesOf, std::int16_t >(),
+      typeKernels< LanesOf, int >(),
+      typeKernels< LanesOf, long long >(),
+      columnRuns< LanesOf< int > >,
+      addSteps< LanesOf< int > >
+    };
+    return kernels;
+  }
+}
+
+const common::simd::Kernels & common::simd::kernelTable()
+{
+  static const Kernels table = makeKernels< NativeLanes >(NATIVE_ISA);
+  return table;
+}
+
+#if defined(__SSE2__) && !defined(COMMON_SIMD_VARIANT)
+const common::simd::Kernels & common::simd::scalar::kernelTable()
+{
+  static const Kernels table = makeKernels< ScalarLanes >("scalar");
+  return table;
+}
+#endif
@@ -0,0 +1,169 @@
+#include <sparse_matrix.hpp>
+#include <algorithm>
+#include <matrix_reader.hpp>
+#include <phase.hpp>
+
+namespace
+{
+  size_t rowLimit(const common::SparseMatrix & mtx, size_t row, size_t cols)
+  {
+    const size_t begin = mtx.rowBegin(row);
+    size_t end = mtx.rowEnd(row);
+    while (end > begin && mtx.column(end - 1) >= cols)
+    {
+      --end;
+    }
+    return end;
+  }
+}
+
+common::SparseMatrix::SparseMatrix(size_t cols):
+  cols_(cols),
+  row_start_(1, 0),
+  columns_(),
+  values_()
+{}
+
+size_t common::SparseMatrix::rows() const
+{
+  return row_start_.size() - 1;
+}
+
+size_t common::SparseMatrix::cols() const
+{
+  return cols_;
+}
+
+size_t common::SparseMatrix::nonzeros() const
+{
+  return values_.size();
+}
+
+size_t common::SparseMatrix::rowBegin(size_t row) const
+{
+  return row_start_[row];
+}
+
+size_t common::SparseMatrix::rowEnd(size_t row) const
+{
+  return row_start_[row + 1];
+}
+
+size_t common::SparseMatrix::column(size_t k) const
+{
+  return columns_[k];
+}
+
+int common::SparseMatrix::value(size_t k) const
+{
+  return values_[k];
+}
+
+void common::SparseMatrix::appendRow(const int * row)
+{
+  for (size_t j = 0; j < cols_; ++j)
+  {
+    if (row[j] != 0)
+    {
+      columns_.push_back(j);
+      values_.push_back(row[j]);
+    }
+  }
+  row_start_.push_back(values_.size());
+}
+
+size_t common::readSparse(std::istream & input, SparseMatrix & mtx, size_t rows)
+{
+  const size_t cols = mtx.cols();
+  if (rows == 0 || cols == 0)
+  {
+    return 0;
+  }
+  Phase phase("read", rows * cols);
+  StreamReader reader(input);
+  std::vector< int > row(cols);
+  size_t done = 0;
+  for (size_t i = 0; i < rows; ++i)
+  {
+    const size_t got = reader.read(row.data(), cols);
+    done += got;
+    if (got != cols)
+    {
+      break;
+    }
+    mtx.appendRow(row.data());
+  }
+  phase.addBytes(reader.consumed());
+  return done;
+}
+
+bool common::zeroAboveDiagonal(const SparseMatrix & mtx, size_t rows, size_t cols)
+{
+  for (size_t i = 0; i < rows && i + 1 < cols; ++i)
+  {
+    const size_t end = rowLimit(mtx, i, cols);
+    if (end != mtx.rowBegin(i) && mtx.column(end - 1) > i)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool common::zeroBelowDiagonal(const SparseMatrix & mtx, size_t rows, size_t cols)
+{
+  for (size_t i = 1; i < rows; ++i)
+  {
+    if (mtx.rowBegin(i) != mtx.rowEnd(i) && mtx.column(mtx.rowBegin(i)) < std::min(i, cols))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t common::distinctColumns(const SparseMatrix & mtx, size_t rows, size_t cols)
+{
+  if (rows < 2)
+  {
+    return cols;
+  }
+  std::vector< size_t > next_row(cols, 0);
+  std::vector< int > last(cols, 0);
+  std::vector< bool > repeated(cols, false);
+  for (size_t i = 0; i < rows; ++i)
+  {
+    const size_t end = rowLimit(mtx, i, cols);
+    for (size_t k = mtx.rowBegin(i); k < end; ++k)
+    {
+      const size_t j = mtx.column(k);
+      const size_t gap = i - next_row[j];
+      if (gap >= 2 || (gap == 0 && i != 0 && last[j] == mtx.value(k)))
+      {
+        repeated[j] = true;
+      }
+      next_row[j] = i + 1;
+      last[j] = mtx.value(k);
+    }
+  }
+  size_t distinct = 0;
+  for (size_t j = 0; j < cols; ++j)
+  {
+    distinct += !repeated[j] && rows - next_row[j] < 2;
+  }
+  return distinct;
+}
+
+common::DiagonalStats common::scanDiagonals(const SparseMatrix & mtx, size_t rows, size_t cols)
+{
+  DiagonalStats stats = DiagonalStats::zeros(rows, cols);
+  for (size_t i = 0; i < rows; ++i)
+  {
+    const size_t end = rowLimit(mtx, i, cols);
+    for (size_t k = mtx.rowBegin(i); k < end; ++k)
+    {
+      stats.update(i, mtx.column(k), 0, mtx.value(k));
+    }
+  }
+  return stats;
+}
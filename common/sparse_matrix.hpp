@@ -0,0 +1,41 @@
+#ifndef SPARSE_MATRIX_HPP
+#define SPARSE_MATRIX_HPP
+
+#include <cstddef>
+#include <istream>
+#include <vector>
+#include <diagonals.hpp>
+
+namespace common
+{
+  class SparseMatrix
+  {
+  public:
+    explicit SparseMatrix(size_t cols);
+
+    size_t rows() const;
+    size_t cols() const;
+    size_t nonzeros() const;
+    size_t rowBegin(size_t row) const;
+    size_t rowEnd(size_t row) const;
+    size_t column(size_t k) const;
+    int value(size_t k) const;
+
+    void appendRow(const int * row);
+
+  private:
+    size_t cols_;
+    std::vector< size_t > row_start_;
+    std::vector< size_t > columns_;
+    std::vector< int > values_;
+  };
+
+  size_t readSparse(std::istream & input, SparseMatrix & mtx, size_t rows);
+
+  bool zeroAboveDiagonal(const SparseMatrix & mtx, size_t rows, size_t cols);
+  bool zeroBelowDiagonal(const SparseMatrix & mtx, size_t rows, size_t cols);
+  size_t distinctColumns(const SparseMatrix & mtx, size_t rows, size_t cols);
+  DiagonalStats scanDiagonals(const SparseMatrix & mtx, size_t rows, size_t cols);
+}
+
+#endif
@@ -0,0 +1,14 @@
+#include <spiral.hpp>
+
+size_t common::spiralRank(SpiralOrder order, size_t rows, size_t cols, size_t row, size_t col)
+{
+  return detail::orientedRank(order, rows, cols, row, col);
+}
+
+void common::spiralRanks(SpiralOrder order, size_t rows, size_t cols, size_t row, unsigned * ranks)
+{
+  for (size_t j = 0; j < cols; ++j)
+  {
+    ranks[j] = static_cast< unsigned >(detail::orientedRank(order, rows, cols, row, j));
+  }
+}
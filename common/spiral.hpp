@@ -0,0 +1,89 @@
+#ifndef SPIRAL_HPP
+#define SPIRAL_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+namespace common
+{
+  enum class SpiralOrder
+  {
+    top_left_clockwise,
+    bottom_left_clockwise,
+    bottom_left_counterclockwise
+  };
+
+  template< size_t Rows, size_t Cols >
+  struct SpiralTable
+  {
+    unsigned ranks[Rows * Cols];
+  };
+
+  size_t spiralRank(SpiralOrder order, size_t rows, size_t cols, size_t row, size_t col);
+  void spiralRanks(SpiralOrder order, size_t rows, size_t cols, size_t row, unsigned * ranks);
+  template< size_t Rows, size_t Cols >
+  constexpr SpiralTable< Rows, Cols > spiralTable(SpiralOrder order);
+}
+
+namespace common
+{
+  namespace detail
+  {
+    constexpr size_t clockwiseRank(size_t rows, size_t cols, size_t i, size_t j)
+    {
+      const size_t k = std::min(std::min(i, j), std::min(rows - 1 - i, cols - 1 - j));
+      const size_t h = rows - 2 * k;
+      const size_t w = cols - 2 * k;
+      const size_t a = i - k;
+      const size_t b = j - k;
+      const size_t before = 2 * k * (rows + cols - 2 * k);
+      size_t pos = 0;
+      if (a == 0)
+      {
+        pos = b;
+      }
+      else if (b == w - 1)
+      {
+        pos = w - 1 + a;
+      }
+      else if (a == h - 1)
+      {
+        pos = 2 * (w - 1) + (h - 1) - b;
+      }
+      else
+      {
+        pos = 2 * (w - 1) + 2 * (h - 1) - a;
+      }
+      return before + pos + 1;
+    }
+
+    constexpr size_t orientedRank(SpiralOrder order, size_t rows, size_t cols, size_t i, size_t j)
+    {
+      switch (order)
+      {
+      case SpiralOrder::bottom_left_clockwise:
+        return clockwiseRank(cols, rows, j, rows - 1 - i);
+      case SpiralOrder::bottom_left_counterclockwise:
+        return clockwiseRank(rows, cols, rows - 1 - i, j);
+      default:
+        return clockwiseRank(rows, cols, i, j);
+      }
+    }
+  }
+}
+
+template< size_t Rows, size_t Cols >
+constexpr common::SpiralTable< Rows, Cols > common::spiralTable(SpiralOrder order)
+{
+  SpiralTable< Rows, Cols > table = {};
+  for (size_t i = 0; i < Rows; ++i)
+  {
+    for (size_t j = 0; j < Cols; ++j)
+    {
+      table.ranks[i * Cols + j] = static_cast< unsigned >(detail::orientedRank(order, Rows, Cols, i, j));
+    }
+  }
+  return table;
+}
+
+#endif
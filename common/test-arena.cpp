@@ -0,0 +1,72 @@
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <new>
+#include <thread>
+#include <arena.hpp>
+
+namespace
+{
+  template< class Fn >
+  void inFreshThread(Fn fn)
+  {
+    std::thread thread(fn);
+    thread.join();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(arena_reuses_spare_block)
+{
+  inFreshThread([]()
+  {
+    BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), 0u);
+    char * first = nullptr;
+    {
+      common::Arena arena(1 << 20);
+      first = arena.allocate< char >(1);
+    }
+    BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), (1u << 20) + common::Arena::ALIGNMENT);
+    {
+      common::Arena arena(1 << 10);
+      BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), 0u);
+      BOOST_REQUIRE(arena.allocate< char >(1) == first);
+      BOOST_REQUIRE_EQUAL(arena.capacity(), 1u << 10);
+    }
+    BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), (1u << 20) + common::Arena::ALIGNMENT);
+  });
+}
+
+BOOST_AUTO_TEST_CASE(arena_spare_is_capped)
+{
+  inFreshThread([]()
+  {
+    const size_t limit = common::Arena::SPARE_LIMIT;
+    {
+      common::Arena arena(limit - common::Arena::ALIGNMENT);
+      BOOST_REQUIRE(arena.allocate< char >(1));
+    }
+    BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), limit);
+    {
+      common::Arena arena(limit * 4);
+      BOOST_REQUIRE(arena.allocate< char >(limit * 4));
+    }
+    BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), limit);
+  });
+  inFreshThread([]()
+  {
+    {
+      common::Arena arena(common::Arena::SPARE_LIMIT);
+      BOOST_REQUIRE(arena.allocate< char >(1));
+    }
+    BOOST_REQUIRE_EQUAL(common::Arena::spareBytes(), 0u);
+  });
+}
+
+BOOST_AUTO_TEST_CASE(arena_array_errors_match_new)
+{
+  common::Arena arena(256);
+  BOOST_REQUIRE(arena.allocateArray< int >(0));
+  BOOST_REQUIRE(arena.allocateArray< int >(64));
+  BOOST_CHECK_THROW(arena.allocateArray< int >(std::numeric_limits< size_t >::max() / 2),
+      std::bad_array_new_length);
+  BOOST_CHECK_THROW(arena.allocateArray< int >(1), std::bad_alloc);
+}
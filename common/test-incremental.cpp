@@ -0,0 +1,141 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include <incremental.hpp>
+
+namespace
+{
+  struct Expected
+  {
+    size_t cross_max;
+    size_t square_max;
+    size_t square_min;
+    size_t saddle;
+    long long min_anti_sum;
+    long long max_offset_sum;
+  };
+
+  bool isExtremum(const std::vector< int > & mtx, size_t cols, size_t i, size_t j, bool square, bool minimum)
+  {
+    const int center = mtx[i * cols + j];
+    for (int di = -1; di <= 1; ++di)
+    {
+      for (int dj = -1; dj <= 1; ++dj)
+      {
+        if ((di == 0 && dj == 0) || (!square && di != 0 && dj != 0))
+        {
+          continue;
+        }
+        const int near = mtx[(i + di) * cols + j + dj];
+        if (minimum ? near <= center : near >= center)
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  long long diagonalSum(const std::vector< int > & mtx, size_t cols, size_t side, size_t row, size_t col)
+  {
+    long long sum = 0;
+    for (; row < side && col < side; ++row, ++col)
+    {
+      sum += mtx[row * cols + col];
+    }
+    return sum;
+  }
+
+  Expected recompute(const std::vector< int > & mtx, size_t rows, size_t cols)
+  {
+    Expected expected = { 0, 0, 0, 0, 0, 0 };
+    for (size_t i = 1; i + 1 < rows; ++i)
+    {
+      for (size_t j = 1; j + 1 < cols; ++j)
+      {
+        expected.cross_max += isExtremum(mtx, cols, i, j, false, false);
+        expected.square_max += isExtremum(mtx, cols, i, j, true, false);
+        expected.square_min += isExtremum(mtx, cols, i, j, true, true);
+      }
+    }
+    for (size_t i = 0; i < rows; ++i)
+    {
+      const int * row = mtx.data() + i * cols;
+      const int row_min = *std::min_element(row, row + cols);
+      for (size_t j = 0; j < cols; ++j)
+      {
+        int col_max = mtx[j];
+        for (size_t k = 1; k < rows; ++k)
+        {
+          col_max = std::max(col_max, mtx[k * cols + j]);
+        }
+        expected.saddle += row[j] == row_min && row[j] == col_max;
+      }
+    }
+    expected.min_anti_sum = std::numeric_limits< long long >::max();
+    for (size_t d = 0; d + 1 < rows + cols; ++d)
+    {
+      long long sum = 0;
+      for (size_t i = 0; i < rows; ++i)
+      {
+        sum += d >= i && d - i < cols ? mtx[i * cols + d - i] : 0;
+      }
+      expected.min_anti_sum = std::min(expected.min_anti_sum, sum);
+    }
+    const size_t side = std::min(rows, cols);
+    expected.max_offset_sum = std::numeric_limits< int >::min();
+    for (size_t s = 1; s <= side / 2; ++s)
+    {
+      const long long upper = diagonalSum(mtx, cols, side, 0, s);
+      const long long lower = diagonalSum(mtx, cols, side, s, 0);
+      expected.max_offset_sum = std::max(expected.max_offset_sum, std::max(upper, lower));
+    }
+    return expected;
+  }
+
+  void checkAnalysis(const common::IncrementalAnalysis & analysis, const std::vector< int > & mtx)
+  {
+    const Expected expected = recompute(mtx, analysis.rows(), analysis.cols());
+    BOOST_REQUIRE_EQUAL(analysis.crossMaxima(), expected.cross_max);
+    BOOST_REQUIRE_EQUAL(analysis.squareMaxima(), expected.square_max);
+    BOOST_REQUIRE_EQUAL(analysis.squareMinima(), expected.square_min);
+    BOOST_REQUIRE_EQUAL(analysis.saddlePoints(), expected.saddle);
+    BOOST_REQUIRE_EQUAL(analysis.minAntiSum(), expected.min_anti_sum);
+    BOOST_REQUIRE_EQUAL(analysis.maxOffsetSum(), expected.max_offset_sum);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(offset_sum_skips_main_diagonal)
+{
+  const std::vector< int > mtx = { 1, 2, 3, 4, 9, 6, 7, 8, 5 };
+  const common::IncrementalAnalysis analysis(common::MatrixView< const int >(mtx.data(), 3, 3));
+  BOOST_CHECK_EQUAL(analysis.maxOffsetSum(), 12);
+}
+
+BOOST_AUTO_TEST_CASE(updates_match_recompute)
+{
+  std::mt19937 random(28);
+  for (size_t round = 0; round < 200; ++round)
+  {
+    const size_t rows = 1 + random() % 7;
+    const size_t cols = 1 + random() % 7;
+    std::vector< int > mtx(rows * cols);
+    for (int & value : mtx)
+    {
+      value = static_cast< int >(random() % 9) - 4;
+    }
+    common::IncrementalAnalysis analysis(common::MatrixView< const int >(mtx.data(), rows, cols));
+    checkAnalysis(analysis, mtx);
+    for (size_t step = 0; step < 30; ++step)
+    {
+      const size_t row = random() % rows;
+      const size_t col = random() % cols;
+      const int value = static_cast< int >(random() % 9) - 4;
+      mtx[row * cols + col] = value;
+      analysis.update(row, col, value);
+      checkAnalysis(analysis, mtx);
+    }
+  }
+}
@@ -0,0 +1,291 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <vector>
+#include <column_stats.hpp>
+#include <multi_query.hpp>
+#include <neighbourhood.hpp>
+#include <triangular.hpp>
+
+namespace
+{
+  template< class T >
+  std::vector< T > randomMatrix(std::mt19937 & random, size_t rows, size_t cols, int spread)
+  {
+    std::uniform_int_distribution< int > value(-spread, spread);
+    std::vector< T > mtx(rows * cols);
+    for (T & x : mtx)
+    {
+      x = value(random);
+    }
+    return mtx;
+  }
+
+  template< class T >
+  size_t columnsWithoutRepeats(const T * mtx, size_t rows, size_t cols, size_t stride)
+  {
+    size_t count = 0;
+    for (size_t j = 0; rows && j < cols; ++j)
+    {
+      bool repeated = false;
+      for (size_t i = 0; i + 1 < rows && !repeated; ++i)
+      {
+        repeated = mtx[i * stride + j] == mtx[(i + 1) * stride + j];
+      }
+      count += !repeated;
+    }
+    return count;
+  }
+
+  template< class T >
+  size_t strictExtrema(const std::vector< T > & mtx, size_t rows, size_t cols, bool square, bool minimum)
+  {
+    size_t count = 0;
+    for (size_t i = 1; i + 1 < rows; ++i)
+    {
+      for (size_t j = 1; j + 1 < cols; ++j)
+      {
+        const T center = mtx[i * cols + j];
+        bool extremum = true;
+        for (int di = -1; di <= 1; ++di)
+        {
+          for (int dj = -1; dj <= 1; ++dj)
+          {
+            if ((di == 0 && dj == 0) || (!square && di != 0 && dj != 0))
+            {
+              continue;
+            }
+            const T near = mtx[(i + di) * cols + j + dj];
+            extremum = extremum && (minimum ? center < near : center > near);
+          }
+        }
+        count += extremum;
+      }
+    }
+    return count;
+  }
+
+  template< class T >
+  bool zeroAbove(const std::vector< T > & mtx, size_t rows, size_t cols)
+  {
+    for (size_t i = 0; i < rows; ++i)
+    {
+      for (size_t j = i + 1; j < cols; ++j)
+      {
+        if (mtx[i * cols + j] != 0)
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool lowerTriangularShift(const std::vector< long long > & mtx, size_t rows, size_t cols)
+  {
+    const bool shiftRows = rows >= cols;
+    const size_t n = shiftRows ? cols : rows;
+    const size_t shift = shiftRows ? rows - cols : cols - rows;
+    if (n == 0)
+    {
+      return true;
+    }
+    for (size_t sh = 0; sh <= shift; ++sh)
+    {
+      bool nonzero = false;
+      for (size_t i = 0; i + 1 < n && !nonzero; ++i)
+      {
+        for (size_t j = i + 1; j < n && !nonzero; ++j)
+        {
+          nonzero = mtx[(i + (shiftRows ? sh : 0)) * cols + j + (shiftRows ? 0 : sh)] != 0;
+        }
+      }
+      if (!nonzero)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template< class T, class Queries >
+  void scanRange(const common::MatrixView< const T > & mtx, Queries & queries, size_t begin, size_t end)
+  {
+    queries.seek(begin);
+    for (size_t i = begin; i < end; ++i)
+    {
+      const T * above = i > 0 ? mtx.row(i - 1) : nullptr;
+      const T * below = i + 1 < mtx.rows() ? mtx.row(i + 1) : nullptr;
+      queries(above, mtx.row(i), below, mtx.cols());
+    }
+  }
+
+  template< class T, class Queries >
+  Queries scanSplit(const common::MatrixView< const T > & mtx, const Queries & empty, size_t split)
+  {
+    Queries head = empty;
+    Queries tail = empty;
+    scanRange(mtx, head, 0, split);
+    scanRange(mtx, tail, split, mtx.rows());
+    head.merge(tail);
+    return head;
+  }
+
+  const size_t SHAPES[][2] = { { 0, 0 }, { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 2 }, { 3, 3 }, { 5, 9 }, { 9, 5 },
+    { 16, 16 }, { 31, 70 }, { 70, 31 }, { 64, 129 } };
+}
+
+BOOST_AUTO_TEST_CASE(column_repeats_and_local_max_match_kuznetsov)
+{
+  std::mt19937 random(21);
+  for (const auto & shape : SHAPES)
+  {
+    for (int spread : { 1, 3, 100 })
+    {
+      const size_t rows = shape[0];
+      const size_t cols = shape[1];
+      const std::vector< int > mtx = randomMatrix< int >(random, rows, cols, spread);
+      const common::MatrixView< const int > view(mtx.data(), rows, cols);
+      const auto empty = common::makeQueries(common::ColumnRepeats< int >(rows ? cols : 0),
+          common::LocalMaxCounter< int >());
+      auto whole = empty;
+      common::scanQueries(view, whole);
+      const auto split = scanSplit(view, empty, rows / 2);
+      const size_t columns = columnsWithoutRepeats(mtx.data(), rows, cols, cols);
+      const size_t maxima = strictExtrema(mtx, rows, cols, true, false);
+      BOOST_REQUIRE_EQUAL(whole.get< 0 >().distinct(), columns);
+      BOOST_REQUIRE_EQUAL(whole.get< 1 >().count(), maxima);
+      BOOST_REQUIRE_EQUAL(split.get< 0 >().distinct(), columns);
+      BOOST_REQUIRE_EQUAL(split.get< 1 >().count(), maxima);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(cross_max_and_zero_above_match_rizatdinov)
+{
+  std::mt19937 random(22);
+  for (const auto & shape : SHAPES)
+  {
+    for (int spread : { 1, 100 })
+    {
+      const size_t rows = shape[0];
+      const size_t cols = shape[1];
+      std::vector< int > mtx = randomMatrix< int >(random, rows, cols, spread);
+      if (spread == 1)
+      {
+        for (size_t i = 0; i < rows; ++i)
+        {
+          for (size_t j = i + 1; j < cols; ++j)
+          {
+            mtx[i * cols + j] = 0;
+          }
+        }
+      }
+      const common::MatrixView< const int > view(mtx.data(), rows, cols);
+      const auto empty = common::makeQueries(common::CrossMaxCounter< int >(), common::ZeroAboveDiagonal< int >());
+      auto whole = empty;
+      common::scanQueries(view, whole);
+      const auto split = scanSplit(view, empty, rows / 3);
+      const size_t maxima = strictExtrema(mtx, rows, cols, false, false);
+      const bool zero = zeroAbove(mtx, rows, cols);
+      BOOST_REQUIRE_EQUAL(whole.get< 0 >().count(), maxima);
+      BOOST_REQUIRE_EQUAL(whole.get< 1 >().zero(), zero);
+      BOOST_REQUIRE_EQUAL(split.get< 0 >().count(), maxima);
+      BOOST_REQUIRE_EQUAL(split.get< 1 >().zero(), zero);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_max_and_min_match_tarasenko)
+{
+  std::mt19937 random(23);
+  for (const auto & shape : SHAPES)
+  {
+    for (int spread : { 2, 1000 })
+    {
+      const size_t rows = shape[0];
+      const size_t cols = shape[1];
+      const std::vector< int > mtx = randomMatrix< int >(random, rows, cols, spread);
+      const common::MatrixView< const int > view(mtx.data(), rows, cols);
+      const auto empty = common::makeQueries(common::LocalMaxCounter< int >(), common::LocalMinCounter< int >());
+      auto whole = empty;
+      common::scanQueries(view, whole);
+      const auto split = scanSplit(view, empty, rows - rows / 4);
+      BOOST_REQUIRE_EQUAL(whole.get< 0 >().count(), strictExtrema(mtx, rows, cols, true, false));
+      BOOST_REQUIRE_EQUAL(whole.get< 1 >().count(), strictExtrema(mtx, rows, cols, true, true));
+      BOOST_REQUIRE_EQUAL(split.get< 0 >().count(), whole.get< 0 >().count());
+      BOOST_REQUIRE_EQUAL(split.get< 1 >().count(), whole.get< 1 >().count());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(triangular_shift_and_cross_max_match_goltsov)
+{
+  std::mt19937 random(24);
+  for (const auto & shape : SHAPES)
+  {
+    for (int zeros = 0; zeros < 3; ++zeros)
+    {
+      const size_t rows = shape[0];
+      const size_t cols = shape[1];
+      std::vector< long long > mtx = randomMatrix< long long >(random, rows, cols, 50);
+      const bool shiftRows = rows >= cols;
+      const size_t n = shiftRows ? cols : rows;
+      const size_t shift = shiftRows ? rows - cols : cols - rows;
+      if (zeros > 0 && n > 0)
+      {
+        const size_t sh = random() % (shift + 1);
+        for (size_t i = 0; i < n; ++i)
+        {
+          for (size_t j = i + 1; j < n; ++j)
+          {
+            mtx[(i + (shiftRows ? sh : 0)) * cols + j + (shiftRows ? 0 : sh)] = 0;
+          }
+        }
+      }
+      const common::MatrixView< const long long > view(mtx.data(), rows, cols);
+      const auto empty = common::makeQueries(common::LowerTriangularShift< long long >(n, shift, shiftRows),
+          common::CrossMaxCounter< long long >());
+      auto whole = empty;
+      common::scanQueries(view, whole);
+      const auto split = scanSplit(view, empty, rows / 2);
+      const bool found = lowerTriangularShift(mtx, rows, cols);
+      const size_t maxima = strictExtrema(mtx, rows, cols, false, false);
+      BOOST_REQUIRE_EQUAL(whole.get< 0 >().found(), found);
+      BOOST_REQUIRE_EQUAL(whole.get< 1 >().count(), maxima);
+      BOOST_REQUIRE_EQUAL(split.get< 0 >().found(), found);
+      BOOST_REQUIRE_EQUAL(split.get< 1 >().count(), maxima);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(square_column_repeats_match_zubarev)
+{
+  std::mt19937 random(25);
+  for (const auto & shape : SHAPES)
+  {
+    const size_t rows = shape[0];
+    const size_t cols = shape[1];
+    const std::vector< int > mtx = randomMatrix< int >(random, rows, cols, 2);
+    const common::MatrixView< const int > square = common::MatrixView< const int >(mtx.data(), rows, cols).square();
+    const size_t side = square.rows();
+    auto queries = common::makeQueries(common::ColumnRepeats< int >(side));
+    common::scanQueries(square, queries);
+    BOOST_REQUIRE_EQUAL(queries.get< 0 >().distinct(), columnsWithoutRepeats(mtx.data(), side, side, cols));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(large_matrix_matches_naive)
+{
+  std::mt19937 random(26);
+  const size_t rows = 1100;
+  const size_t cols = 1000;
+  const std::vector< int > mtx = randomMatrix< int >(random, rows, cols, 1 << 20);
+  const common::MatrixView< const int > view(mtx.data(), rows, cols);
+  auto queries = common::makeQueries(common::ColumnRepeats< int >(cols), common::LocalMaxCounter< int >(),
+      common::LocalMinCounter< int >(), common::CrossMaxCounter< int >());
+  common::scanQueries(view, queries);
+  BOOST_REQUIRE_EQUAL(queries.get< 0 >().distinct(), columnsWithoutRepeats(mtx.data(), rows, cols, cols));
+  BOOST_REQUIRE_EQUAL(queries.get< 1 >().count(), strictExtrema(mtx, rows, cols, true, false));
+  BOOST_REQUIRE_EQUAL(queries.get< 2 >().count(), strictExtrema(mtx, rows, cols, true, true));
+  BOOST_REQUIRE_EQUAL(queries.get< 3 >().count(), strictExtrema(mtx, rows, cols, false, false));
+}
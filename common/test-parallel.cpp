@@ -0,0 +1,157 @@
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <parallel.hpp>
+#include <test-threads.hpp>
+
+namespace
+{
+  struct RowSums
+  {
+    std::vector< long long > sums;
+
+    void merge(const RowSums & other)
+    {
+      for (size_t i = 0; i < sums.size(); ++i)
+      {
+        sums[i] += other.sums[i];
+      }
+    }
+  };
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_runs_every_task_once)
+{
+  for (size_t workers : { 0, 1, 3, 7 })
+  {
+    common::ThreadPool pool(workers);
+    BOOST_REQUIRE_EQUAL(pool.size(), workers + 1);
+    for (size_t tasks : { 0, 1, 2, 5, 64, 1000 })
+    {
+      std::unique_ptr< std::atomic< int >[] > runs(new std::atomic< int >[tasks + 1]);
+      for (size_t i = 0; i < tasks; ++i)
+      {
+        runs[i] = 0;
+      }
+      std::vector< long long > results(tasks, 0);
+      pool.run(tasks, [&runs, &results](size_t i)
+      {
+        ++runs[i];
+        results[i] = static_cast< long long >(i * i);
+      });
+      for (size_t i = 0; i < tasks; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(runs[i].load(), 1);
+        BOOST_REQUIRE_EQUAL(results[i], static_cast< long long >(i * i));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_nested_runs_complete)
+{
+  common::ThreadPool pool(3);
+  const size_t outer = 16;
+  const size_t inner = 50;
+  std::vector< long long > sums(outer, 0);
+  std::atomic< size_t > calls(0);
+  pool.run(outer, [&pool, &sums, &calls, inner](size_t i)
+  {
+    std::vector< long long > part(inner, 0);
+    pool.run(inner, [&part, &calls, i](size_t j)
+    {
+      part[j] = static_cast< long long >((i * 100 + j) * (i * 100 + j));
+      ++calls;
+    });
+    for (long long value : part)
+    {
+      sums[i] += value;
+    }
+  });
+  BOOST_REQUIRE_EQUAL(calls.load(), outer * inner);
+  for (size_t i = 0; i < outer; ++i)
+  {
+    long long expected = 0;
+    for (size_t j = 0; j < inner; ++j)
+    {
+      expected += static_cast< long long >((i * 100 + j) * (i * 100 + j));
+    }
+    BOOST_REQUIRE_EQUAL(sums[i], expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(thread_pools_run_from_several_threads)
+{
+  common::ThreadPool pool(2);
+  std::atomic< size_t > total(0);
+  std::vector< std::thread > callers;
+  for (size_t t = 0; t < 4; ++t)
+  {
+    callers.emplace_back([&pool, &total]()
+    {
+      for (size_t round = 0; round < 20; ++round)
+      {
+        pool.run(30, [&total](size_t i)
+        {
+          total += i;
+        });
+      }
+    });
+  }
+  for (std::thread & caller : callers)
+  {
+    caller.join();
+  }
+  BOOST_REQUIRE_EQUAL(total.load(), 4 * 20 * (29 * 30 / 2));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_tiles_match_sequential_sums)
+{
+  std::mt19937 random(39);
+  std::uniform_int_distribution< int > value(-1000, 1000);
+  const size_t SHAPES[][2] = { { 1, 1 }, { 3, 1000 }, { 1024, 1024 }, { 5000, 300 } };
+  ThreadsSetting setting("4");
+  for (const auto & shape : SHAPES)
+  {
+    const size_t rows = shape[0];
+    const size_t cols = shape[1];
+    std::vector< int > mtx(rows * cols);
+    for (int & x : mtx)
+    {
+      x = value(random);
+    }
+    std::vector< long long > expected(cols, 0);
+    for (size_t i = 0; i < rows; ++i)
+    {
+      for (size_t j = 0; j < cols; ++j)
+      {
+        expected[j] += mtx[i * cols + j];
+      }
+    }
+    BOOST_REQUIRE(rows * cols < 1 << 19 || common::tileCount(rows, cols) > 1);
+    RowSums result = { std::vector< long long >(cols, 0) };
+    std::vector< int > covered(rows, 0);
+    common::parallelTiles(rows, cols, result, [&mtx, &covered, cols](RowSums & part, size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        ++covered[i];
+        for (size_t j = 0; j < cols; ++j)
+        {
+          part.sums[j] += mtx[i * cols + j];
+        }
+      }
+    });
+    for (size_t i = 0; i < rows; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(covered[i], 1);
+    }
+    for (size_t j = 0; j < cols; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(result.sums[j], expected[j]);
+    }
+  }
+}
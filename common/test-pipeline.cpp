@@ -0,0 +1,131 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pipeline.hpp>
+#include <test-threads.hpp>
+
+namespace
+{
+  struct AddRowIndex
+  {
+    size_t cols;
+
+    void operator()(int * mtx, size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        for (size_t j = 0; j < cols; ++j)
+        {
+          mtx[i * cols + j] = mtx[i * cols + j] * 3 + static_cast< int >(i);
+        }
+      }
+    }
+  };
+
+  struct Collect
+  {
+    std::vector< int > values;
+
+    void operator()(const int * rows, size_t count)
+    {
+      values.insert(values.end(), rows, rows + count);
+    }
+  };
+
+  std::vector< int > randomValues(std::mt19937 & random, size_t count)
+  {
+    std::uniform_int_distribution< int > value(-100000, 100000);
+    std::vector< int > values(count);
+    for (int & x : values)
+    {
+      x = value(random);
+    }
+    return values;
+  }
+
+  std::string toText(const std::vector< int > & values, size_t count)
+  {
+    std::ostringstream text;
+    for (size_t i = 0; i < count; ++i)
+    {
+      text << values[i] << (i % 17 == 16 ? '\n' : ' ');
+    }
+    return text.str();
+  }
+
+  void checkPipeline(const std::vector< int > & values, size_t rows, size_t cols, size_t given)
+  {
+    std::istringstream input(toText(values, given));
+    std::vector< int > mtx(rows * cols);
+    AddRowIndex transform = { cols };
+    Collect emit;
+    const size_t done = common::pipelineRows(input, mtx.data(), rows, cols, transform, emit);
+    BOOST_REQUIRE_EQUAL(done, given);
+    const size_t complete = given / cols;
+    BOOST_REQUIRE_EQUAL(emit.values.size(), complete * cols);
+    for (size_t i = 0; i < complete; ++i)
+    {
+      for (size_t j = 0; j < cols; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(emit.values[i * cols + j], values[i * cols + j] * 3 + static_cast< int >(i));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(spsc_queue_keeps_order_across_threads)
+{
+  common::SpscQueue< size_t > queue(3);
+  size_t value = 0;
+  BOOST_REQUIRE(!queue.pop(value));
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE(queue.push(i));
+  }
+  BOOST_REQUIRE(!queue.push(4));
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE(queue.pop(value));
+    BOOST_REQUIRE_EQUAL(value, i);
+  }
+  const size_t count = 200000;
+  std::thread producer([&queue, count]()
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      queue.waitPush(i * 7 + 1);
+    }
+  });
+  bool ordered = true;
+  for (size_t i = 0; i < count; ++i)
+  {
+    queue.waitPop(value);
+    ordered = ordered && value == i * 7 + 1;
+  }
+  producer.join();
+  BOOST_REQUIRE(ordered);
+  BOOST_REQUIRE(!queue.pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(pipeline_rows_match_sequential_transform)
+{
+  std::mt19937 random(30);
+  const size_t SHAPES[][2] = { { 1, 1 }, { 3, 5 }, { 600, 500 }, { 4, 70000 }, { 1000, 263 } };
+  for (const char * threads : { "1", "4" })
+  {
+    ThreadsSetting setting(threads);
+    BOOST_REQUIRE_EQUAL(common::pipelineEnabled(600, 500), threads[0] != '1');
+    for (const auto & shape : SHAPES)
+    {
+      const size_t rows = shape[0];
+      const size_t cols = shape[1];
+      const std::vector< int > values = randomValues(random, rows * cols);
+      checkPipeline(values, rows, cols, rows * cols);
+      std::uniform_int_distribution< size_t > cut(0, rows * cols - 1);
+      checkPipeline(values, rows, cols, cut(random));
+    }
+  }
+}
@@ -0,0 +1,163 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sparse_matrix.hpp>
+
+namespace
+{
+  std::vector< int > randomSparse(std::mt19937 & random, size_t rows, size_t cols, int percent)
+  {
+    std::uniform_int_distribution< int > chance(0, 99);
+    std::uniform_int_distribution< int > value(-3, 3);
+    std::vector< int > mtx(rows * cols, 0);
+    for (int & x : mtx)
+    {
+      x = chance(random) < percent ? value(random) : 0;
+    }
+    return mtx;
+  }
+
+  std::string toText(const std::vector< int > & values, size_t count)
+  {
+    std::ostringstream text;
+    for (size_t i = 0; i < count; ++i)
+    {
+      text << values[i] << ' ';
+    }
+    return text.str();
+  }
+
+  size_t distinctColumns(const std::vector< int > & mtx, size_t stride, size_t rows, size_t cols)
+  {
+    size_t count = 0;
+    for (size_t j = 0; j < cols; ++j)
+    {
+      bool repeated = false;
+      for (size_t i = 0; i + 1 < rows && !repeated; ++i)
+      {
+        repeated = mtx[i * stride + j] == mtx[(i + 1) * stride + j];
+      }
+      count += !repeated;
+    }
+    return count;
+  }
+
+  bool zeroTriangle(const std::vector< int > & mtx, size_t stride, size_t rows, size_t cols, bool above)
+  {
+    for (size_t i = 0; i < rows; ++i)
+    {
+      for (size_t j = above ? i + 1 : 0; j < (above ? cols : std::min(i, cols)); ++j)
+      {
+        if (mtx[i * stride + j] != 0)
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void checkDiagonals(const common::DiagonalStats & stats, const std::vector< int > & mtx, size_t stride,
+      size_t rows, size_t cols)
+  {
+    std::vector< long long > main(stats.size(), 0);
+    std::vector< long long > anti(stats.size(), 0);
+    std::vector< size_t > main_zeros(stats.size(), 0);
+    std::vector< size_t > anti_zeros(stats.size(), 0);
+    for (size_t i = 0; i < rows; ++i)
+    {
+      for (size_t j = 0; j < cols; ++j)
+      {
+        const int x = mtx[i * stride + j];
+        main[stats.mainIndex(i, j)] += x;
+        anti[stats.antiIndex(i, j)] += x;
+        main_zeros[stats.mainIndex(i, j)] += x == 0;
+        anti_zeros[stats.antiIndex(i, j)] += x == 0;
+      }
+    }
+    for (size_t d = 0; d < stats.size(); ++d)
+    {
+      BOOST_REQUIRE_EQUAL(stats.mainSum(d), main[d]);
+      BOOST_REQUIRE_EQUAL(stats.antiSum(d), anti[d]);
+      BOOST_REQUIRE_EQUAL(stats.mainZeros(d), main_zeros[d]);
+      BOOST_REQUIRE_EQUAL(stats.antiZeros(d), anti_zeros[d]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_sparse_keeps_nonzeros_in_row_order)
+{
+  std::mt19937 random(33);
+  for (int percent : { 0, 5, 50, 100 })
+  {
+    const size_t rows = 1 + random() % 40;
+    const size_t cols = 1 + random() % 40;
+    const std::vector< int > dense = randomSparse(random, rows, cols, percent);
+    const size_t given = random() % (rows * cols + 1);
+    std::istringstream input(toText(dense, given));
+    common::SparseMatrix sparse(cols);
+    BOOST_REQUIRE_EQUAL(common::readSparse(input, sparse, rows), given);
+    BOOST_REQUIRE_EQUAL(sparse.rows(), given / cols);
+    size_t nonzeros = 0;
+    for (size_t i = 0; i < sparse.rows(); ++i)
+    {
+      size_t k = sparse.rowBegin(i);
+      for (size_t j = 0; j < cols; ++j)
+      {
+        if (dense[i * cols + j] == 0)
+        {
+          continue;
+        }
+        BOOST_REQUIRE(k < sparse.rowEnd(i));
+        BOOST_REQUIRE_EQUAL(sparse.column(k), j);
+        BOOST_REQUIRE_EQUAL(sparse.value(k), dense[i * cols + j]);
+        ++k;
+        ++nonzeros;
+      }
+      BOOST_REQUIRE_EQUAL(k, sparse.rowEnd(i));
+    }
+    BOOST_REQUIRE_EQUAL(sparse.nonzeros(), nonzeros);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sparse_queries_match_dense)
+{
+  std::mt19937 random(34);
+  for (size_t round = 0; round < 400; ++round)
+  {
+    const size_t rows = 1 + random() % 24;
+    const size_t cols = 1 + random() % 24;
+    const int percent = static_cast< int >(random() % 4) * 30;
+    std::vector< int > dense = randomSparse(random, rows, cols, percent);
+    if (round % 3 == 0)
+    {
+      for (size_t i = 0; i < rows; ++i)
+      {
+        for (size_t j = 0; j < cols; ++j)
+        {
+          dense[i * cols + j] = (round % 2 ? j > i : j < i) ? 0 : dense[i * cols + j];
+        }
+      }
+    }
+    common::SparseMatrix sparse(cols);
+    for (size_t i = 0; i < rows; ++i)
+    {
+      sparse.appendRow(dense.data() + i * cols);
+    }
+    const size_t used_rows = 1 + random() % rows;
+    const size_t used_cols = 1 + random() % cols;
+    BOOST_TEST_CONTEXT(rows << 'x' << cols << " as " << used_rows << 'x' << used_cols << " at " << percent << '%')
+    {
+      BOOST_REQUIRE_EQUAL(common::zeroAboveDiagonal(sparse, used_rows, used_cols),
+          zeroTriangle(dense, cols, used_rows, used_cols, true));
+      BOOST_REQUIRE_EQUAL(common::zeroBelowDiagonal(sparse, used_rows, used_cols),
+          zeroTriangle(dense, cols, used_rows, used_cols, false));
+      BOOST_REQUIRE_EQUAL(common::distinctColumns(sparse, used_rows, used_cols),
+          distinctColumns(dense, cols, used_rows, used_cols));
+      checkDiagonals(common::scanDiagonals(sparse, used_rows, used_cols), dense, cols, used_rows, used_cols);
+    }
+  }
+}
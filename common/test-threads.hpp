@@ -0,0 +1,35 @@
+#ifndef TEST_THREADS_HPP
+#define TEST_THREADS_HPP
+
+#include <cstdlib>
+#include <string>
+
+class ThreadsSetting
+{
+public:
+  explicit ThreadsSetting(const char * threads)
+  {
+    const char * value = std::getenv("MATRIX_THREADS");
+    had_ = value != nullptr;
+    old_ = had_ ? value : "";
+    setenv("MATRIX_THREADS", threads, 1);
+  }
+
+  ~ThreadsSetting()
+  {
+    if (had_)
+    {
+      setenv("MATRIX_THREADS", old_.c_str(), 1);
+    }
+    else
+    {
+      unsetenv("MATRIX_THREADS");
+    }
+  }
+
+private:
+  bool had_;
+  std::string old_;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include <tiled_file.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const size_t TILE_BYTES = 16 << 20;
+}
+
+common::TiledFile::TiledFile():
+  fd_(-1),
+  file_(),
+  header_(),
+  valid_(false)
+{}
+
+common::TiledFile::TiledFile(const char * path):
+  TiledFile()
+{
+  open(path);
+}
+
+common::TiledFile::~TiledFile()
+{
+  close();
+}
+
+size_t common::TiledFile::tileRows(size_t cols, size_t width)
+{
+  const size_t row = cols * width;
+  return row != 0 && row < TILE_BYTES ? TILE_BYTES / row : 1;
+}
+
+bool common::TiledFile::binaryMatrix(ElementType type, size_t & rows, size_t & cols) const
+{
+  if (!valid_ || header_.type != type)
+  {
+    return false;
+  }
+  rows = header_.rows;
+  cols = header_.cols;
+  return true;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+bool common::TiledFile::open(const char * path)
+{
+  close();
+  fd_ = ::open(path, O_RDONLY);
+  if (fd_ < 0)
+  {
+    return false;
+  }
+  struct stat info = {};
+  char head[sizeof(BinaryHeader)] = {};
+  if (::fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode)
+      || ::pread(fd_, head, sizeof(head), 0) != static_cast< ssize_t >(sizeof(head))
+      || !parseBinaryHeader(head, static_cast< size_t >(info.st_size), header_))
+  {
+    close();
+    return false;
+  }
+#ifdef POSIX_FADV_SEQUENTIAL
+  ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  valid_ = true;
+  return true;
+}
+
+void common::TiledFile::close()
+{
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+  fd_ = -1;
+  valid_ = false;
+}
+
+bool common::TiledFile::readRows(char * dest, size_t first, size_t count, size_t cols)
+{
+  const size_t width = elementSize(header_.type);
+  const size_t stride = header_.cols * width;
+  const size_t length = cols == header_.cols ? count * stride : cols * width;
+  const size_t pieces = cols == header_.cols ? 1 : count;
+  for (size_t piece = 0; piece < pieces; ++piece)
+  {
+    off_t offset = static_cast< off_t >(sizeof(BinaryHeader) + (first + piece) * stride);
+    char * out = dest + piece * length;
+    for (size_t left = length; left != 0; )
+    {
+      const ssize_t got = ::pread(fd_, out, left, offset);
+      if (got < 0 && errno == EINTR)
+      {
+        continue;
+      }
+      if (got <= 0)
+      {
+        return false;
+      }
+      out += got;
+      offset += got;
+      left -= static_cast< size_t >(got);
+    }
+  }
+  return true;
+}
+
+void common::TiledFile::release(size_t first, size_t count)
+{
+#ifdef POSIX_FADV_DONTNEED
+  const size_t stride = header_.cols * elementSize(header_.type);
+  ::posix_fadvise(fd_, static_cast< off_t >(sizeof(BinaryHeader) + first * stride),
+      static_cast< off_t >(count * stride), POSIX_FADV_DONTNEED);
+#else
+  static_cast< void >(first);
+  static_cast< void >(count);
+#endif
+}
+#else
+bool common::TiledFile::open(const char * path)
+{
+  close();
+  file_.open(path, std::ios::binary | std::ios::ate);
+  if (!file_)
+  {
+    return false;
+  }
+  const size_t size = static_cast< size_t >(file_.tellg());
+  char head[sizeof(BinaryHeader)] = {};
+  file_.seekg(0);
+  if (!file_.read(head, sizeof(head)) || !parseBinaryHeader(head, size, header_))
+  {
+    close();
+    return false;
+  }
+  valid_ = true;
+  return true;
+}
+
+void common::TiledFile::close()
+{
+  file_.close();
+  valid_ = false;
+}
+
+bool common::TiledFile::readRows(char * dest, size_t first, size_t count, size_t cols)
+{
+  const size_t width = elementSize(header_.type);
+  const size_t stride = header_.cols * width;
+  for (size_t i = 0; i < count; ++i)
+  {
+    file_.seekg(static_cast< std::streamoff >(sizeof(BinaryHeader) + (first + i) * stride));
+    if (!file_.read(dest + i * cols * width, static_cast< std::streamsize >(cols * width)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void common::TiledFile::release(size_t, size_t)
+{}
+#endif
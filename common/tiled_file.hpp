@@ -0,0 +1,100 @@
+#ifndef TILED_FILE_HPP
+#define TILED_FILE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <matrix_binary.hpp>
+#include <phase.hpp>
+
+namespace common
+{
+  class TiledFile
+  {
+  public:
+    TiledFile();
+    explicit TiledFile(const char * path);
+    ~TiledFile();
+    TiledFile(const TiledFile &) = delete;
+    TiledFile & operator=(const TiledFile &) = delete;
+
+    bool open(const char * path);
+    void close();
+    bool binaryMatrix(ElementType type, size_t & rows, size_t & cols) const;
+
+    template< class T, class Kernel >
+    size_t scanRows(size_t rows, size_t cols, Kernel & kernel);
+
+    static size_t tileRows(size_t cols, size_t width);
+
+  private:
+    int fd_;
+    std::ifstream file_;
+    BinaryHeader header_;
+    bool valid_;
+
+    bool readRows(char * dest, size_t first, size_t count, size_t cols);
+    void release(size_t first, size_t count);
+  };
+}
+
+template< class T, class Kernel >
+size_t common::TiledFile::scanRows(size_t rows, size_t cols, Kernel & kernel)
+{
+  if (rows == 0 || cols == 0 || !valid_ || sizeof(T) != elementSize(header_.type))
+  {
+    return 0;
+  }
+  rows = std::min< size_t >(rows, header_.rows);
+  cols = std::min< size_t >(cols, header_.cols);
+  Phase phase("tiles", rows * cols);
+  const size_t tile = std::min(tileRows(cols, sizeof(T)), rows);
+  std::vector< T > current(tile * cols);
+  std::vector< T > next(tile * cols);
+  std::vector< T > carry(cols);
+  if (!readRows(reinterpret_cast< char * >(current.data()), 0, tile, cols))
+  {
+    return 0;
+  }
+  size_t done = 0;
+  for (size_t begin = 0; begin < rows; begin += tile)
+  {
+    const size_t count = std::min(tile, rows - begin);
+    const size_t following = std::min(tile, rows - begin - count);
+    bool prefetched = true;
+    std::thread loader;
+    if (following != 0)
+    {
+      loader = std::thread([&]()
+      {
+        prefetched = readRows(reinterpret_cast< char * >(next.data()), begin + count, following, cols);
+      });
+    }
+    const T * above = begin > 0 ? carry.data() : nullptr;
+    const T * row = current.data();
+    for (size_t i = 0; i + 1 < count; ++i, row += cols)
+    {
+      kernel(above, row, row + cols, cols);
+      above = row;
+    }
+    if (loader.joinable())
+    {
+      loader.join();
+    }
+    if (!prefetched)
+    {
+      break;
+    }
+    kernel(above, row, following != 0 ? next.data() : nullptr, cols);
+    done += count * cols;
+    std::copy(row, row + cols, carry.begin());
+    release(begin, count);
+    current.swap(next);
+  }
+  phase.addBytes(done * sizeof(T));
+  return done;
+}
+
+#endif
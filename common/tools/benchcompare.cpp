@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+  struct Result
+  {
+    std::string shape;
+    size_t rows;
+    size_t cols;
+    std::string phase;
+    double nsPerCell;
+  };
+
+  const double DEFAULT_THRESHOLD = 10.0;
+  const double DEFAULT_FLOOR = 0.05;
+
+  class JsonReader
+  {
+  public:
+    explicit JsonReader(const std::string & text);
+
+    bool readResults(std::vector< Result > & results);
+
+  private:
+    const std::string & text_;
+    size_t pos_;
+
+    void skipSpaces();
+    bool accept(char c);
+    bool readString(std::string & value);
+    bool readNumber(double & value);
+    bool readResult(Result & result);
+    bool skipValue();
+    template< class Fn >
+    bool readObject(Fn field);
+  };
+
+  JsonReader::JsonReader(const std::string & text):
+    text_(text),
+    pos_(0)
+  {}
+
+  void JsonReader::skipSpaces()
+  {
+    while (pos_ < text_.size() && std::strchr(" \t\r\n", text_[pos_]))
+    {
+      ++pos_;
+    }
+  }
+
+  bool JsonReader::accept(char c)
+  {
+    skipSpaces();
+    if (pos_ < text_.size() && text_[pos_] == c)
+    {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  bool JsonReader::readString(std::string & value)
+  {
+    if (!accept('"'))
+    {
+      return false;
+    }
+    value.clear();
+    while (pos_ < text_.size() && text_[pos_] != '"')
+    {
+      char c = text_[pos_++];
+      if (c == '\\')
+      {
+        if (pos_ >= text_.size())
+        {
+          return false;
+        }
+        c = text_[pos_++];
+        if (c == 'u')
+        {
+          pos_ += 4;
+          c = '?';
+        }
+        else if (c == 'n' || c == 't' || c == 'r' || c == 'b' || c == 'f')
+        {
+          c = ' ';
+        }
+      }
+      value += c;
+    }
+    return accept('"');
+  }
+
+  bool JsonReader::readNumber(double & value)
+  {
+    skipSpaces();
+    const char * begin = text_.c_str() + pos_;
+    char * end = nullptr;
+    value = std::strtod(begin, &end);
+    if (end == begin)
+    {
+      return false;
+    }
+    pos_ += end - begin;
+    return true;
+  }
+
+  template< class Fn >
+  bool JsonReader::readObject(Fn field)
+  {
+    if (!accept('{'))
+    {
+      return false;
+    }
+    if (accept('}'))
+    {
+      return true;
+    }
+    do
+    {
+      std::string key;
+      if (!readString(key) || !accept(':') || !field(key))
+      {
+        return false;
+      }
+    }
+    while (accept(','));
+    return accept('}');
+  }
+
+  bool JsonReader::skipValue()
+  {
+    skipSpaces();
+    if (pos_ >= text_.size())
+    {
+      return false;
+    }
+    const char c = text_[pos_];
+    if (c == '"')
+    {
+      std::string ignored;
+      return readString(ignored);
+    }
+    if (c == '{')
+    {
+      return readObject([this](const std::string &)
+      {
+        return skipValue();
+      });
+    }
+    if (c == '[')
+    {
+      ++pos_;
+      if (accept(']'))
+      {
+        return true;
+      }
+      do
+      {
+        if (!skipValue())
+        {
+          return false;
+        }
+      }
+      while (accept(','));
+      return accept(']');
+    }
+    for (const char * word : { "true", "false", "null" })
+    {
+      if (text_.compare(pos_, std::strlen(word), word) == 0)
+      {
+        pos_ += std::strlen(word);
+        return true;
+      }
+    }
+    double ignored = 0.0;
+    return readNumber(ignored);
+  }
+
+  bool JsonReader::readResult(Result & result)
+  {
+    return readObject([this, &result](const std::string & key)
+    {
+      double number = 0.0;
+      if (key == "shape")
+      {
+        return readString(result.shape);
+      }
+      if (key == "phase")
+      {
+        return readString(result.phase);
+      }
+      if (key == "rows" || key == "cols" || key == "ns_per_cell")
+      {
+        if (!readNumber(number))
+        {
+          return false;
+        }
+        if (key == "ns_per_cell")
+        {
+          result.nsPerCell = number;
+        }
+        else
+        {
+          (key == "rows" ? result.rows : result.cols) = static_cast< size_t >(number);
+        }
+        return true;
+      }
+      return skipValue();
+    });
+  }
+
+  bool JsonReader::readResults(std::vector< Result > & results)
+  {
+    return readObject([this, &results](const std::string & key)
+    {
+      if (key != "results")
+      {
+        return skipValue();
+      }
+      if (!accept('['))
+      {
+        return false;
+      }
+      if (accept(']'))
+      {
+        return true;
+      }
+      do
+      {
+        Result result = { std::string(), 0, 0, std::string(), 0.0 };
+        if (!readResult(result))
+        {
+          return false;
+        }
+        results.push_back(result);
+      }
+      while (accept(','));
+      return accept(']');
+    });
+  }
+
+  bool loadResults(const char * path, std::vector< Result > & results)
+  {
+    std::ifstream input(path);
+    if (!input)
+    {
+      std::cerr << "Can't open " << path << '\n';
+      return false;
+    }
+    const std::string text((std::istreambuf_iterator< char >(input)), std::istreambuf_iterator< char >());
+    JsonReader reader(text);
+    if (!reader.readResults(results))
+    {
+      std::cerr << path << ": bad benchmark results\n";
+      return false;
+    }
+    return true;
+  }
+
+  bool sameCase(const Result & lhs, const Result & rhs)
+  {
+    return lhs.shape == rhs.shape && lhs.rows == rhs.rows && lhs.cols == rhs.cols && lhs.phase == rhs.phase;
+  }
+
+  bool parseLimit(const char * arg, const char * key, double & value)
+  {
+    const size_t length = std::strlen(key);
+    if (std::strncmp(arg, key, length) != 0 || arg[length] != '=')
+    {
+      return false;
+    }
+    char * end = nullptr;
+    value = std::strtod(arg + length + 1, &end);
+    return end != arg + length + 1 && *end == '\0' && value >= 0.0;
+  }
+
+  void usage()
+  {
+    std::cerr << "Usage: benchcompare <base.json> <new.json> [threshold=<percent>] [floor=<ns/cell>]\n";
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc < 3)
+  {
+    usage();
+    return 1;
+  }
+  double threshold = DEFAULT_THRESHOLD;
+  double floor = DEFAULT_FLOOR;
+  for (int i = 3; i < argc; ++i)
+  {
+    if (!parseLimit(argv[i], "threshold", threshold) && !parseLimit(argv[i], "floor", floor))
+    {
+      usage();
+      return 1;
+    }
+  }
+  std::vector< Result > base;
+  std::vector< Result > current;
+  if (!loadResults(argv[1], base) || !loadResults(argv[2], current))
+  {
+    return 2;
+  }
+  size_t slower = 0;
+  std::cout << "shape rows cols phase base new change status\n";
+  for (const Result & old : base)
+  {
+    const auto match = std::find_if(current.begin(), current.end(), [&old](const Result & result)
+    {
+      return sameCase(old, result);
+    });
+    const Result * found = match != current.end() ? &*match : nullptr;
+    std::cout << old.shape << ' ' << old.rows << ' ' << old.cols << ' ' << old.phase << ' ' << old.nsPerCell << ' ';
+    if (!found)
+    {
+      std::cout << "- - missing\n";
+      continue;
+    }
+    const double change = old.nsPerCell > 0.0 ? (found->nsPerCell - old.nsPerCell) * 100.0 / old.nsPerCell : 0.0;
+    const bool noise = old.nsPerCell < floor && found->nsPerCell < floor;
+    const char * status = "ok";
+    if (!noise && change > threshold)
+    {
+      status = "slower";
+      ++slower;
+    }
+    else if (!noise && change < -threshold)
+    {
+      status = "faster";
+    }
+    std::cout << found->nsPerCell << ' ' << std::showpos << std::fixed << std::setprecision(1) << change << '%';
+    std::cout << std::noshowpos << std::defaultfloat << std::setprecision(6) << ' ' << status << '\n';
+  }
+  if (slower)
+  {
+    std::cerr << slower << " phase(s) slower by more than " << threshold << "%\n";
+    return 3;
+  }
+  return 0;
+}
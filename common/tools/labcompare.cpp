@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <direct.h>
+#endif
+
+namespace
+{
+  struct Implementation
+  {
+    const char * task;
+    const char * variant;
+    const char * lab;
+    const char * phase;
+    size_t firstLine;
+    size_t lastLine;
+    size_t token;
+  };
+
+  const size_t LAST = 0;
+  const size_t WHOLE = 0;
+
+  const Implementation IMPLEMENTATIONS[] = {
+    { "local-max", "cross", "hvostov.daniil", "countLocalMax", 1, 1, WHOLE },
+    { "local-max", "cross", "goltsov.vadim", "lwrTriMtx+cntLocMax", 2, 2, WHOLE },
+    { "local-max", "cross", "rizatdinov.askar", "countLocalMax+isLowerTriangular", 1, 1, 1 },
+    { "local-max", "square", "kuznetsov.petr", "cntColNsm+cntLocMax", 2, 2, WHOLE },
+    { "local-max", "square", "tarasenko.yaroslav", "cnt_loc_extrema", 1, 1, WHOLE },
+    { "spiral", "bottom-left-clockwise", "khasnulin.roman", "lftBotClk", 1, 1, WHOLE },
+    { "spiral", "bottom-left-clockwise", "kudaev.georgii", "lftBotClk", 1, 1, WHOLE },
+    { "spiral", "top-left-clockwise", "vasyakin.kirill", "transformSpiral", 2, LAST, WHOLE },
+    { "spiral", "bottom-left-counterclockwise", "stupir.anna", "addSnail", 1, 1, WHOLE },
+    { "column-repeats", "all-rows", "kuznetsov.petr", "cntColNsm+cntLocMax", 1, 1, WHOLE },
+    { "column-repeats", "all-rows", "zharov.danil", "getCntColNsm", 2, 2, WHOLE },
+    { "column-repeats", "leading-square", "zubarev.arsenii", "getCouOfColNoIden", 1, 1, WHOLE }
+  };
+
+  struct Measurement
+  {
+    const Implementation * implementation;
+    std::string shape;
+    size_t rows;
+    size_t cols;
+    double nsPerCell;
+    std::string answer;
+    bool agrees;
+  };
+
+#if defined(__unix__) || defined(__APPLE__)
+  std::string quoted(const std::string & text)
+  {
+    std::string result = "'";
+    for (char c : text)
+    {
+      result += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return result + '\'';
+  }
+
+  FILE * openPipe(const std::string & command)
+  {
+    return popen(command.c_str(), "r");
+  }
+
+  int closePipe(FILE * pipe)
+  {
+    return pclose(pipe);
+  }
+
+  bool makeWorkdir(std::string & workdir)
+  {
+    const char * dir = std::getenv("TMPDIR");
+    workdir = std::string(dir && *dir ? dir : "/tmp") + "/matrix-compare-XXXXXX";
+    return mkdtemp(&workdir[0]) != nullptr;
+  }
+
+  void removeWorkdir(const std::string & workdir)
+  {
+    rmdir(workdir.c_str());
+  }
+#else
+  std::string quoted(const std::string & text)
+  {
+    std::string result = "\"";
+    for (char c : text)
+    {
+      result += c == '"' ? std::string("\\\"") : std::string(1, c);
+    }
+    return result + '"';
+  }
+
+  FILE * openPipe(const std::string & command)
+  {
+    return _popen(command.c_str(), "r");
+  }
+
+  int closePipe(FILE * pipe)
+  {
+    return _pclose(pipe);
+  }
+
+  bool makeWorkdir(std::string & workdir)
+  {
+    const char * dir = std::getenv("TEMP");
+    workdir = std::string(dir && *dir ? dir : ".") + "/matrix-compare";
+    return _mkdir(workdir.c_str()) == 0;
+  }
+
+  void removeWorkdir(const std::string & workdir)
+  {
+    _rmdir(workdir.c_str());
+  }
+#endif
+
+  bool extractAnswer(const std::string & path, const Implementation & implementation, std::string & answer)
+  {
+    std::ifstream input(path);
+    if (!input)
+    {
+      return false;
+    }
+    std::string line;
+    answer.clear();
+    for (size_t number = 1; std::getline(input, line); ++number)
+    {
+      if (number < implementation.firstLine)
+      {
+        continue;
+      }
+      if (implementation.lastLine != LAST && number > implementation.lastLine)
+      {
+        break;
+      }
+      if (implementation.token == WHOLE)
+      {
+        answer += answer.empty() ? line : '\n' + line;
+        continue;
+      }
+      std::istringstream tokens(line);
+      std::string token;
+      for (size_t i = 0; i < implementation.token && tokens >> token; ++i)
+      {}
+      answer = token;
+      return !token.empty();
+    }
+    return !answer.empty();
+  }
+
+  int measure(const Implementation & implementation, const std::string & labs, const std::string & options,
+      const std::string & workdir, std::vector< Measurement > & measurements)
+  {
+    const std::string keep = workdir + '/' + implementation.lab;
+    const std::string command = quoted(labs + '/' + implementation.lab + "/P3/lab") + " --bench" + options
+        + " keep=" + quoted(keep);
+    FILE * pipe = openPipe(command);
+    if (!pipe)
+    {
+      std::cerr << "Can't run " << implementation.lab << '\n';
+      return 2;
+    }
+    std::string report;
+    char buffer[4096];
+    for (size_t size = 0; (size = std::fread(buffer, 1, sizeof(buffer), pipe)) != 0; )
+    {
+      report.append(buffer, size);
+    }
+    int code = closePipe(pipe) == 0 ? 0 : 2;
+    if (code != 0)
+    {
+      std::cerr << implementation.lab << ": benchmark failed\n";
+    }
+    std::istringstream lines(report);
+    std::string line;
+    std::getline(lines, line);
+    while (std::getline(lines, line))
+    {
+      std::istringstream fields(line);
+      Measurement measurement = { &implementation, std::string(), 0, 0, 0.0, std::string(), true };
+      std::string phase;
+      size_t calls = 0;
+      fields >> measurement.shape >> measurement.rows >> measurement.cols >> phase >> calls >> measurement.nsPerCell;
+      if (!fields || phase != implementation.phase)
+      {
+        continue;
+      }
+      const std::string kept = keep + '.' + measurement.shape + '.' + std::to_string(measurement.rows) + 'x'
+          + std::to_string(measurement.cols);
+      const bool answered = extractAnswer(kept, implementation, measurement.answer);
+      std::remove(kept.c_str());
+      if (!answered)
+      {
+        std::cerr << implementation.lab << ": no answer for " << measurement.shape << ' ' << measurement.rows << 'x'
+            << measurement.cols << '\n';
+        code = 2;
+        continue;
+      }
+      measurements.push_back(measurement);
+    }
+    return code;
+  }
+
+  bool sameCase(const Measurement & lhs, const Measurement & rhs)
+  {
+    return lhs.shape == rhs.shape && lhs.rows == rhs.rows && lhs.cols == rhs.cols;
+  }
+
+  bool compareAnswers(std::vector< Measurement > & measurements)
+  {
+    bool agree = true;
+    for (size_t i = 0; i < measurements.size(); ++i)
+    {
+      for (size_t j = 0; j < i; ++j)
+      {
+        const bool peer = sameCase(measurements[i], measurements[j])
+            && !std::strcmp(measurements[i].implementation->variant, measurements[j].implementation->variant);
+        if (peer && measurements[i].answer != measurements[j].answer)
+        {
+          measurements[i].agrees = false;
+          measurements[j].agrees = false;
+          agree = false;
+        }
+      }
+    }
+    return agree;
+  }
+
+  void printTimings(std::ostream & out, std::vector< Measurement > & measurements)
+  {
+    std::stable_sort(measurements.begin(), measurements.end(), [](const Measurement & lhs, const Measurement & rhs)
+    {
+      return lhs.shape != rhs.shape ? lhs.shape < rhs.shape : lhs.rows * lhs.cols < rhs.rows * rhs.cols;
+    });
+    out << "shape rows cols lab variant phase ns/cell answer\n";
+    for (const Measurement & measurement : measurements)
+    {
+      out << measurement.shape << ' ' << measurement.rows << ' ' << measurement.cols << ' ';
+      out << measurement.implementation->lab << ' ' << measurement.implementation->variant << ' ';
+      out << measurement.implementation->phase << ' ' << measurement.nsPerCell << ' ';
+      out << (measurement.agrees ? "agrees" : "differs") << '\n';
+    }
+  }
+
+  void usage()
+  {
+    std::cerr << "Usage: labcompare <task> [labs=<dir>] [benchmark options]\n";
+    std::cerr << "Tasks:";
+    const char * last = "";
+    for (const Implementation & implementation : IMPLEMENTATIONS)
+    {
+      if (std::strcmp(implementation.task, last))
+      {
+        std::cerr << ' ' << implementation.task;
+        last = implementation.task;
+      }
+    }
+    std::cerr << '\n';
+    std::cerr << "Labs solving one task share the common kernels: agreement checks their input and output handling,\n";
+    std::cerr << "and timings show per-lab overhead, so they are listed unranked.\n";
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc < 2)
+  {
+    usage();
+    return 1;
+  }
+  std::string labs = "out";
+  std::string options;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (!std::strncmp(argv[i], "labs=", 5))
+    {
+      labs = argv[i] + 5;
+    }
+    else
+    {
+      options += ' ' + quoted(argv[i]);
+    }
+  }
+  std::string workdir;
+  if (!makeWorkdir(workdir))
+  {
+    std::cerr << "Can't create working directory\n";
+    return 2;
+  }
+  std::vector< Measurement > measurements;
+  int code = 0;
+  bool known = false;
+  for (const Implementation & implementation : IMPLEMENTATIONS)
+  {
+    if (!std::strcmp(implementation.task, argv[1]))
+    {
+      known = true;
+      const int result = measure(implementation, labs, options, workdir, measurements);
+      code = code ? code : result;
+    }
+  }
+  removeWorkdir(workdir);
+  if (!known)
+  {
+    usage();
+    return 1;
+  }
+  if (!compareAnswers(measurements))
+  {
+    code = code ? code : 3;
+  }
+  printTimings(std::cout, measurements);
+  return code;
+}
@@ -0,0 +1,111 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <input_file.hpp>
+#include <matrix_binary.hpp>
+#include <matrix_reader.hpp>
+
+namespace
+{
+  template< class T >
+  int toBinary(const char * from, const char * to)
+  {
+    std::ifstream input(from);
+    size_t rows = 0, cols = 0;
+    if (!(input >> rows >> cols))
+    {
+      std::cerr << "Cannot read matrix size\n";
+      return 2;
+    }
+    T * mtx = nullptr;
+    try
+    {
+      mtx = new T[rows * cols];
+    }
+    catch (const std::bad_alloc &)
+    {
+      std::cerr << "Not enough memory\n";
+      return 3;
+    }
+    if (!common::readMatrix(input, mtx, rows, cols))
+    {
+      std::cerr << "Cannot read matrix elements\n";
+      delete[] mtx;
+      return 2;
+    }
+    std::ofstream output(to, std::ios::binary);
+    bool written = static_cast< bool >(common::writeBinaryMatrix(output, mtx, rows, cols));
+    delete[] mtx;
+    if (!written)
+    {
+      std::cerr << "Cannot write output file\n";
+      return 2;
+    }
+    return 0;
+  }
+
+  template< class T >
+  void writeText(std::ostream & output, const T * mtx, size_t rows, size_t cols)
+  {
+    output << rows << ' ' << cols << '\n';
+    for (size_t i = 0; i < rows; ++i)
+    {
+      for (size_t j = 0; j < cols; ++j)
+      {
+        output << (j ? " " : "") << mtx[i * cols + j];
+      }
+      output << '\n';
+    }
+  }
+
+  int toText(const char * from, const char * to)
+  {
+    common::InputFile input(from, true);
+    size_t rows = 0, cols = 0;
+    int * narrow = nullptr;
+    long long * wide = nullptr;
+    std::ofstream output(to);
+    if (input.binaryMatrix(narrow, rows, cols))
+    {
+      writeText(output, narrow, rows, cols);
+    }
+    else if (input.binaryMatrix(wide, rows, cols))
+    {
+      writeText(output, wide, rows, cols);
+    }
+    else
+    {
+      std::cerr << "Not a binary matrix file\n";
+      return 2;
+    }
+    if (!output)
+    {
+      std::cerr << "Cannot write output file\n";
+      return 2;
+    }
+    return 0;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc == 5 && !std::strcmp(argv[1], "to-binary"))
+  {
+    if (!std::strcmp(argv[2], "int"))
+    {
+      return toBinary< int >(argv[3], argv[4]);
+    }
+    if (!std::strcmp(argv[2], "long"))
+    {
+      return toBinary< long long >(argv[3], argv[4]);
+    }
+  }
+  else if (argc == 4 && !std::strcmp(argv[1], "to-text"))
+  {
+    return toText(argv[2], argv[3]);
+  }
+  std::cerr << "Usage: mtxconv to-binary int|long <text> <binary>\n";
+  std::cerr << "       mtxconv to-text <binary> <text>\n";
+  return 1;
+}
@@ -0,0 +1,67 @@
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <incremental.hpp>
+#include <matrix_reader.hpp>
+#include <matrix_writer.hpp>
+
+namespace
+{
+  void report(common::BufferedWriter & writer, const common::IncrementalAnalysis & analysis)
+  {
+    writer << analysis.crossMaxima() << ' ' << analysis.squareMaxima() << ' ' << analysis.squareMinima() << ' ';
+    writer << analysis.saddlePoints() << ' ' << analysis.minAntiSum() << ' ' << analysis.maxOffsetSum() << '\n';
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc != 3)
+  {
+    std::cerr << "Usage: mtxupdate <matrix> <updates>\n";
+    return 1;
+  }
+  std::ifstream input(argv[1]);
+  size_t rows = 0, cols = 0;
+  if (!(input >> rows >> cols))
+  {
+    std::cerr << "Cannot read matrix size\n";
+    return 2;
+  }
+  std::vector< int > mtx(rows * cols);
+  if (!common::readMatrix(input, mtx.data(), rows, cols))
+  {
+    std::cerr << "Cannot read matrix elements\n";
+    return 2;
+  }
+  std::ifstream updates(argv[2]);
+  if (!updates)
+  {
+    std::cerr << "Cannot open updates\n";
+    return 2;
+  }
+  common::IncrementalAnalysis analysis(common::MatrixView< const int >(mtx.data(), rows, cols));
+  common::BufferedWriter writer(std::cout);
+  writer << "row col value cross_max square_max square_min saddle min_anti_sum max_offset_sum\n";
+  writer << "- - - ";
+  report(writer, analysis);
+  size_t row = 0, col = 0;
+  int value = 0;
+  while (updates >> row >> col >> value)
+  {
+    if (row >= rows || col >= cols)
+    {
+      std::cerr << "Update " << row << ' ' << col << " is out of range\n";
+      return 2;
+    }
+    analysis.update(row, col, value);
+    writer << row << ' ' << col << ' ' << value << ' ';
+    report(writer, analysis);
+  }
+  if (!updates.eof())
+  {
+    std::cerr << "Cannot read updates\n";
+    return 2;
+  }
+  return 0;
+}
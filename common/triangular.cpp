@@ -0,0 +1,183 @@
+#include <triangular.hpp>
+#include <vector>
+#include <simd_kernels.hpp>
+
+namespace
+{
+  template< class T >
+  size_t findNonzero(const T * values, size_t from, size_t to)
+  {
+    return common::simd::kernelsFor< T >().next_nonzero(values, from, to);
+  }
+
+  template< class T >
+  bool zeroAbove(const T * mtx, size_t rows, size_t cols, size_t stride)
+  {
+    for (size_t i = 0; i < rows && i + 1 < cols; ++i)
+    {
+      if (findNonzero(mtx + i * stride, i + 1, cols) != cols)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template< class T >
+  bool zeroBelow(const T * mtx, size_t rows, size_t cols, size_t stride)
+  {
+    for (size_t i = 1; i < rows; ++i)
+    {
+      const size_t end = i < cols ? i : cols;
+      if (findNonzero(mtx + i * stride, 0, end) != end)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void block(int * blocked, long long from, long long to, size_t shift)
+  {
+    if (from < 0)
+    {
+      from = 0;
+    }
+    if (to > static_cast< long long >(shift))
+    {
+      to = shift;
+    }
+    if (from <= to)
+    {
+      ++blocked[from];
+      --blocked[to + 1];
+    }
+  }
+
+  template< class T >
+  void blockRow(const T * row, size_t i, size_t n, size_t shift, bool shiftRows, int * blocked)
+  {
+    const long long side = n;
+    const long long row_index = i;
+    if (shiftRows)
+    {
+      if (i + 1 >= n + shift)
+      {
+        return;
+      }
+      size_t last = n;
+      while (last > 0 && row[last - 1] == 0)
+      {
+        --last;
+      }
+      if (last != 0)
+      {
+        const long long column = last - 1;
+        const long long from = column < side - 1 ? row_index - column + 1 : row_index - side + 2;
+        block(blocked, from, row_index, shift);
+      }
+    }
+    else if (i + 1 < n)
+    {
+      const size_t end = n + shift;
+      for (size_t c = findNonzero(row, i + 1, end); c < end; c = findNonzero(row, c + 1, end))
+      {
+        const long long column = c;
+        block(blocked, column - side + 1, column - row_index - 1, shift);
+      }
+    }
+  }
+
+  template< class T >
+  bool lowerTriangularShift(const T * mtx, size_t n, size_t shift, size_t stride, bool shiftRows)
+  {
+    if (n == 0)
+    {
+      return true;
+    }
+    std::vector< int > blocked(shift + 2, 0);
+    const size_t rows = shiftRows ? n + shift : n;
+    for (size_t i = 0; i < rows; ++i)
+    {
+      blockRow(mtx + i * stride, i, n, shift, shiftRows, blocked.data());
+    }
+    return common::hasFreeShift(blocked.data(), shift);
+  }
+}
+
+size_t common::nextNonzero(const int * values, size_t from, size_t to)
+{
+  return findNonzero(values, from, to);
+}
+
+size_t common::nextNonzero(const long long * values, size_t from, size_t to)
+{
+  return findNonzero(values, from, to);
+}
+
+bool common::allZero(const int * values, size_t count)
+{
+  return findNonzero(values, 0, count) == count;
+}
+
+bool common::allZero(const long long * values, size_t count)
+{
+  return findNonzero(values, 0, count) == count;
+}
+
+bool common::zeroAboveDiagonal(const int * mtx, size_t rows, size_t cols, size_t stride)
+{
+  return zeroAbove(mtx, rows, cols, stride);
+}
+
+bool common::zeroAboveDiagonal(const long long * mtx, size_t rows, size_t cols, size_t stride)
+{
+  return zeroAbove(mtx, rows, cols, stride);
+}
+
+bool common::zeroBelowDiagonal(const int * mtx, size_t rows, size_t cols, size_t stride)
+{
+  return zeroBelow(mtx, rows, cols, stride);
+}
+
+bool common::zeroBelowDiagonal(const long long * mtx, size_t rows, size_t cols, size_t stride)
+{
+  return zeroBelow(mtx, rows, cols, stride);
+}
+
+bool common::hasLowerTriangularShift(const int * mtx, size_t n, size_t shift, size_t stride, bool shiftRows)
+{
+  return lowerTriangularShift(mtx, n, shift, stride, shiftRows);
+}
+
+bool common::hasLowerTriangularShift(const long long * mtx, size_t n, size_t shift, size_t stride,
+    bool shiftRows)
+{
+  return lowerTriangularShift(mtx, n, shift, stride, shiftRows);
+}
+
+void common::blockTriangularShifts(const int * row, size_t i, size_t n, size_t shift, bool shiftRows,
+    int * blocked)
+{
+  blockRow(row, i, n, shift, shiftRows, blocked);
+}
+
+void common::blockTriangularShifts(const long long * row, size_t i, size_t n, size_t shift, bool shiftRows,
+    int * blocked)
+{
+  blockRow(row, i, n, shift, shiftRows, blocked);
+}
+
+bool common::hasFreeShift(const int * blocked, size_t shift)
+{
+  int covered = 0;
+  for (size_t sh = 0; sh <= shift; ++sh)
+  {
+    covered += blocked[sh];
+    if (covered == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,114 @@
+#ifndef TRIANGULAR_HPP
+#define TRIANGULAR_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace common
+{
+  size_t nextNonzero(const int * values, size_t from, size_t to);
+  size_t nextNonzero(const long long * values, size_t from, size_t to);
+  bool allZero(const int * values, size_t count);
+  bool allZero(const long long * values, size_t count);
+
+  bool zeroAboveDiagonal(const int * mtx, size_t rows, size_t cols, size_t stride);
+  bool zeroAboveDiagonal(const long long * mtx, size_t rows, size_t cols, size_t stride);
+  bool zeroBelowDiagonal(const int * mtx, size_t rows, size_t cols, size_t stride);
+  bool zeroBelowDiagonal(const long long * mtx, size_t rows, size_t cols, size_t stride);
+
+  bool hasLowerTriangularShift(const int * mtx, size_t n, size_t shift, size_t stride, bool shiftRows);
+  bool hasLowerTriangularShift(const long long * mtx, size_t n, size_t shift, size_t stride, bool shiftRows);
+  void blockTriangularShifts(const int * row, size_t i, size_t n, size_t shift, bool shiftRows, int * blocked);
+  void blockTriangularShifts(const long long * row, size_t i, size_t n, size_t shift, bool shiftRows,
+      int * blocked);
+  bool hasFreeShift(const int * blocked, size_t shift);
+
+  template< class T >
+  class ZeroAboveDiagonal
+  {
+  public:
+    ZeroAboveDiagonal();
+    void operator()(size_t i, const T * above, const T * row, const T * below, size_t cols);
+    void merge(const ZeroAboveDiagonal & other);
+    bool zero() const;
+
+  private:
+    bool zero_;
+  };
+
+  template< class T >
+  class LowerTriangularShift
+  {
+  public:
+    LowerTriangularShift(size_t n, size_t shift, bool shiftRows);
+    void operator()(size_t i, const T * above, const T * row, const T * below, size_t cols);
+    void merge(const LowerTriangularShift & other);
+    bool found() const;
+
+  private:
+    size_t n_;
+    size_t shift_;
+    bool shift_rows_;
+    std::vector< int > blocked_;
+  };
+}
+
+template< class T >
+common::ZeroAboveDiagonal< T >::ZeroAboveDiagonal():
+  zero_(true)
+{}
+
+template< class T >
+void common::ZeroAboveDiagonal< T >::operator()(size_t i, const T *, const T * row, const T *, size_t cols)
+{
+  if (zero_ && i + 1 < cols)
+  {
+    zero_ = allZero(row + i + 1, cols - i - 1);
+  }
+}
+
+template< class T >
+void common::ZeroAboveDiagonal< T >::merge(const ZeroAboveDiagonal & other)
+{
+  zero_ = zero_ && other.zero_;
+}
+
+template< class T >
+bool common::ZeroAboveDiagonal< T >::zero() const
+{
+  return zero_;
+}
+
+template< class T >
+common::LowerTriangularShift< T >::LowerTriangularShift(size_t n, size_t shift, bool shiftRows):
+  n_(n),
+  shift_(shift),
+  shift_rows_(shiftRows),
+  blocked_(n ? shift + 2 : 0, 0)
+{}
+
+template< class T >
+void common::LowerTriangularShift< T >::operator()(size_t i, const T *, const T * row, const T *, size_t)
+{
+  if (n_ != 0)
+  {
+    blockTriangularShifts(row, i, n_, shift_, shift_rows_, blocked_.data());
+  }
+}
+
+template< class T >
+void common::LowerTriangularShift< T >::merge(const LowerTriangularShift & other)
+{
+  for (size_t sh = 0; sh < blocked_.size(); ++sh)
+  {
+    blocked_[sh] += other.blocked_[sh];
+  }
+}
+
+template< class T >
+bool common::LowerTriangularShift< T >::found() const
+{
+  return n_ == 0 || hasFreeShift(blocked_.data(), shift_);
+}
+
+#endif
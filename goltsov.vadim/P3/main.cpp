@@ -1,16 +1,34 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <row_window.hpp>
+#include <neighbourhood.hpp>
+#include <multi_query.hpp>
+#include <triangular.hpp>
 
 namespace goltsov
 {
-  long long * create(size_t rows, size_t cols);
+  long long * create(common::Arena & arena, size_t rows, size_t cols);
   std::istream & getMtx(long long * mtx, size_t rows, size_t cols, std::istream & input);
-  bool lwrTriMtx(const long long * mtx, size_t n, size_t shift, size_t cols, size_t flag1, size_t flag2);
-  size_t cntLocMax(const long long * mtx, size_t rows, size_t cols);
+  using Triangular = common::LowerTriangularShift< long long >;
+  using Answers = common::MultiQuery< Triangular, common::CrossMaxCounter< long long > >;
+
+  Triangular lwrTriMtx(size_t n, size_t shift, size_t flag1, size_t flag2);
+  Answers answer(const long long * mtx, size_t rows, size_t cols);
+  int run(int argc, char ** argv);
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, goltsov::run);
+}
+
+int goltsov::run(int argc, char ** argv)
 {
   if (argc < 4)
   {
@@ -39,26 +57,26 @@ int main(int argc, char ** argv)
 
   num = argv[1][0] - '0';
 
-  if (num != 1 && num != 2)
+  if (num < 1 || num > 3)
   {
     std::cerr << "First parameter is out of range\n";
     return 1;
   }
 
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], num == 3);
   size_t rows = 0;
   size_t cols = 0;
-  input >> rows >> cols;
+  long long * mtx = nullptr;
+  bool mapped = input.binaryMatrix(mtx, rows, cols);
 
-  if (!input)
+  if (!mapped && !(input >> rows >> cols))
   {
     std::cerr << "Bad input\n";
     return 2;
   }
 
-  long long * mtx = nullptr;
-
-  if (num == 1)
+  common::Arena arena(!mapped && num != 1 ? common::Arena::bytes< long long >(rows * cols) : 0);
+  if (!mapped && num == 1)
   {
     long long autoMtx[10000];
     mtx = autoMtx;
@@ -69,9 +87,9 @@ int main(int argc, char ** argv)
       return 2;
     }
   }
-  else
+  else if (!mapped)
   {
-    mtx = goltsov::create(rows, cols);
+    mtx = goltsov::create(arena, rows, cols);
     if (mtx == nullptr)
     {
       std::cerr << "Bad alloc" << '\n';
@@ -81,96 +99,38 @@ int main(int argc, char ** argv)
     if (!goltsov::getMtx(mtx, rows, cols, input))
     {
       std::cerr << "Bad input\n";
-      free(mtx);
       return 2;
     }
   }
 
-  bool answer1;
-
-  if (rows < cols)
-  {
-    answer1 = goltsov::lwrTriMtx(mtx, rows, cols - rows, cols, 0, 1);
-  }
-  else
-  {
-    answer1 = goltsov::lwrTriMtx(mtx, cols, rows - cols, cols, 1, 0);
-  }
-
-  size_t answer2 = goltsov::cntLocMax(mtx, rows, cols);
+  goltsov::Answers answers = goltsov::answer(mtx, rows, cols);
+  bool answer1 = answers.get< 0 >().found();
+  size_t answer2 = answers.get< 1 >().count();
 
   std::ofstream output(argv[3]);
   output << answer1 << '\n';
   output << answer2 << '\n';
-
-  if (num == 2)
-  {
-    free(mtx);
-  }
+  return 0;
 }
 
-bool goltsov::lwrTriMtx(const long long * mtx, size_t n, size_t shift, size_t cols, size_t flag1, size_t flag2)
+goltsov::Triangular goltsov::lwrTriMtx(size_t n, size_t shift, size_t flag1, size_t flag2)
 {
-  if (n == 0)
-  {
-    return true;
-  }
-
-  for (size_t sh = 0; sh <= shift; ++sh)
-  {
-    bool flag = false;
-
-    for (size_t i = 0; i < n - 1 && !flag; ++i)
-    {
-      for (size_t j = i + 1; j < n; ++j)
-      {
-        if (mtx[(i + sh * flag1) * cols + j + sh * flag2])
-        {
-          flag = true;
-          break;
-        }
-      }
-    }
-
-    if (!flag)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return Triangular(n, shift, flag1 != 0 && flag2 == 0);
 }
 
-size_t goltsov::cntLocMax(const long long * mtx, size_t rows, size_t cols)
+goltsov::Answers goltsov::answer(const long long * mtx, size_t rows, size_t cols)
 {
-  size_t answer = 0;
-  if (rows <= 2 || cols <= 2)
-  {
-    return 0;
-  }
-
-  for (size_t i = 1; i < rows - 1; ++i)
-  {
-    for (size_t j = 1; j < cols - 1; ++j)
-    {
-      if (mtx[i * cols + j] > mtx[(i - 1) * cols + j] && mtx[i * cols + j] > mtx[(i + 1) * cols + j])
-      {
-        if (mtx[i * cols + j] > mtx[i * cols + j - 1] && mtx[i * cols + j] > mtx[i * cols + j + 1])
-        {
-          ++answer;
-        }
-      }
-    }
-  }
-
-  return answer;
+  common::Phase phase("lwrTriMtx+cntLocMax", rows * cols);
+  Triangular triangular = rows < cols ?
+      lwrTriMtx(rows, cols - rows, 0, 1) : lwrTriMtx(cols, rows - cols, 1, 0);
+  Answers answers = common::makeQueries(triangular, common::CrossMaxCounter< long long >());
+  common::scanQueries(mtx, rows, cols, answers);
+  return answers;
 }
 
-long long * goltsov::create(size_t rows, size_t cols)
+long long * goltsov::create(common::Arena & arena, size_t rows, size_t cols)
 {
-  long long * mtx = reinterpret_cast< long long * >(malloc(sizeof(long long) * rows * cols));
-
-  return mtx;
+  return arena.allocate< long long >(rows * cols);
 }
 
 std::istream & goltsov::getMtx(long long * mtx, size_t rows, size_t cols, std::istream & input)
@@ -180,12 +140,5 @@ std::istream & goltsov::getMtx(long long * mtx, size_t rows, size_t cols, std::i
     return input;
   }
 
-  for (size_t i = 0; i < rows; ++i)
-  {
-    for (size_t j = 0; j < cols; ++j)
-    {
-      input >> mtx[i * cols + j];
-    }
-  }
-  return input;
+  return common::readMatrix(input, mtx, rows, cols);
 }
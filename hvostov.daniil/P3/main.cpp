@@ -1,15 +1,37 @@
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <padded_matrix.hpp>
+#include <matrix_writer.hpp>
+#include <row_window.hpp>
+#include <neighbourhood.hpp>
+#include <parallel.hpp>
 
 namespace hvostov {
-  std::ifstream & inputMatrix(std::ifstream & input, int * matrix, size_t rows, size_t cols);
+  using Matrix = common::MatrixView< int >;
+  std::istream & inputMatrix(std::istream & input, int * matrix, size_t rows, size_t cols);
+  std::istream & inputMatrix(std::istream & input, common::PaddedMatrix< int > & matrix);
   size_t countLocalMax(const int * matrix, size_t rows, size_t cols);
-  void modifyMatrix(int * matrix, size_t rows, size_t cols);
-  void outputMatrix(std::ofstream & output, const int * matrix, size_t rows, size_t cols);
+  size_t countLocalMax(common::PaddedMatrix< int > & matrix);
+  size_t ringStart(size_t rows, size_t cols, size_t ring);
+  void modifyRows(const Matrix & matrix, size_t begin, size_t end);
+  void modifyMatrix(const Matrix & matrix);
+  void outputMatrix(std::ofstream & output, const Matrix & matrix);
   void taskExecution(std::ofstream & output, int * matrix, size_t rows, size_t cols);
+  void taskExecution(std::ofstream & output, common::PaddedMatrix< int > & matrix);
+  int run(int argc, char ** argv);
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, hvostov::run);
+}
+
+int hvostov::run(int argc, char ** argv)
 {
   if (argc > 4) {
     std::cerr << "Too many arguments!\n";
@@ -20,14 +42,17 @@ int main(int argc, char ** argv)
   } else if (!std::isdigit(argv[1][0]) || argv[1][1] != '\0') {
     std::cerr << "First parameter is not a number!\n";
     return 1;
-  } else if (argv[1][0] < '1' || argv[1][0] > '2') {
+  } else if (argv[1][0] < '1' || argv[1][0] > '3') {
     std::cerr << "First parameter is out of range!\n";
     return 1;
   }
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], argv[1][0] == '3');
   std::ofstream output(argv[3]);
   size_t rows = 0, cols = 0;
-  input >> rows >> cols;
+  int * mapped = nullptr;
+  if (!input.binaryMatrix(mapped, rows, cols)) {
+    input >> rows >> cols;
+  }
   if (!input) {
     std::cerr << "Problems with input_matrix!\n";
     return 2;
@@ -36,27 +61,30 @@ int main(int argc, char ** argv)
     output << 0 << "\n" << 0 << " " << 0 << "\n";
     return 0;
   }
-  constexpr size_t MATRIX_SIZE = 10000;
-  int * matrix = nullptr;
-  int primary_matrix[MATRIX_SIZE] = {};
-  int * dynamic_primary_matrix = nullptr;
-  if (argv[1][0] == '1') {
-    matrix = primary_matrix;
-  } else {
-    dynamic_primary_matrix = reinterpret_cast< int * >(malloc(sizeof(int) * rows * cols));
-    if (dynamic_primary_matrix == nullptr) {
+  if (mapped) {
+    hvostov::taskExecution(output, mapped, rows, cols);
+    return 0;
+  }
+  if (argv[1][0] != '1') {
+    common::PaddedMatrix< int > matrix(rows, cols);
+    if (!matrix.allocated()) {
       std::cerr << "Bad alloc!\n";
       return 3;
     }
-    matrix = dynamic_primary_matrix;
+    if (!hvostov::inputMatrix(input, matrix)) {
+      std::cerr << "Bad input!\n";
+      return 2;
+    }
+    hvostov::taskExecution(output, matrix);
+    return 0;
   }
+  constexpr size_t MATRIX_SIZE = 10000;
+  int matrix[MATRIX_SIZE] = {};
   if (!hvostov::inputMatrix(input, matrix, rows, cols)) {
     std::cerr << "Bad input!\n";
-    free(dynamic_primary_matrix);
     return 2;
   }
   hvostov::taskExecution(output, matrix, rows, cols);
-  free(dynamic_primary_matrix);
   return 0;
 }
 
@@ -64,70 +92,108 @@ void hvostov::taskExecution(std::ofstream & output, int * matrix, size_t rows, s
 {
   size_t counter = hvostov::countLocalMax(matrix, rows, cols);
   output << counter << "\n";
-  hvostov::modifyMatrix(matrix, rows, cols);
-  hvostov::outputMatrix(output, matrix, rows, cols);
+  hvostov::modifyMatrix(Matrix(matrix, rows, cols));
+  hvostov::outputMatrix(output, Matrix(matrix, rows, cols));
 }
 
-std::ifstream & hvostov::inputMatrix(std::ifstream & input, int * matrix, size_t rows, size_t cols)
+void hvostov::taskExecution(std::ofstream & output, common::PaddedMatrix< int > & matrix)
 {
-  for (size_t i = 0; i < rows * cols; i++) {
-    input >> matrix[i];
-  }
+  size_t counter = hvostov::countLocalMax(matrix);
+  output << counter << "\n";
+  hvostov::modifyMatrix(matrix.view());
+  hvostov::outputMatrix(output, matrix.view());
+}
+
+std::istream & hvostov::inputMatrix(std::istream & input, int * matrix, size_t rows, size_t cols)
+{
+  common::readMatrix(input, matrix, rows, cols);
+  return input;
+}
+
+std::istream & hvostov::inputMatrix(std::istream & input, common::PaddedMatrix< int > & matrix)
+{
+  common::readIntegers(input, matrix);
   return input;
 }
 
 size_t hvostov::countLocalMax(const int * matrix, size_t rows, size_t cols)
 {
-  if (rows < 3 || cols < 3) {
-    return 0;
-  }
-  size_t counter = 0;
-  for (size_t i = 1; i < rows - 1; i++) {
-    for (size_t j = 1; j < cols - 1; j++) {
-      bool is_local_max = matrix[i * cols + j] > matrix[i * cols + j - 1];
-      is_local_max = is_local_max && matrix[i * cols + j] > matrix[i * cols + j + 1];
-      is_local_max = is_local_max && matrix[i * cols + j] > matrix[(i - 1) * cols + j];
-      is_local_max = is_local_max && matrix[i * cols + j] > matrix[(i + 1) * cols + j];
-      if (is_local_max) {
-        counter++;
-      }
-    }
-  }
-  return counter;
+  common::Phase phase("countLocalMax", rows * cols);
+  common::CrossMaxCounter< int > counter;
+  common::parallelScanRows(matrix, rows, cols, counter);
+  return counter.count();
 }
 
-void hvostov::outputMatrix(std::ofstream & output, const int * matrix, size_t rows, size_t cols)
+size_t hvostov::countLocalMax(common::PaddedMatrix< int > & matrix)
 {
-  output << rows << " " << cols;
-  for (size_t i = 0; i < rows * cols; i++) {
-    output << " " << matrix[i];
+  common::Phase phase("countLocalMax", matrix.rows() * matrix.cols());
+  return common::countExtrema< common::StrictMax, common::CrossShape >(matrix);
+}
+
+void hvostov::outputMatrix(std::ofstream & output, const Matrix & matrix)
+{
+  common::BufferedWriter writer(output);
+  writer << matrix.rows() << ' ' << matrix.cols();
+  if (matrix.rows() * matrix.cols() != 0) {
+    writer << ' ';
+    writer.write(common::MatrixView< const int >(matrix), ' ');
   }
-  output << "\n";
+  writer << '\n';
 }
 
-void hvostov::modifyMatrix(int * matrix, size_t rows, size_t cols)
+size_t hvostov::ringStart(size_t rows, size_t cols, size_t ring)
 {
-  size_t top = 0, right = cols - 1, bot = rows - 1, left = 0, decrease_by = 1;
-  while (top <= bot && left <= right) {
-    for (size_t i = bot; i > top; i--) {
-      matrix[i * cols + left] -= decrease_by;
-      decrease_by++;
+  return 1 + 2 * ring * (rows + cols - 2 * ring);
+}
+
+void hvostov::modifyRows(const Matrix & matrix, size_t begin, size_t end)
+{
+  const size_t rows = matrix.rows(), cols = matrix.cols();
+  const size_t rings = std::min((rows + 1) / 2, (cols + 1) / 2);
+  for (size_t i = begin; i < end; i++) {
+    int * row = matrix.row(i);
+    const size_t ring = std::min(i, rows - 1 - i);
+    const size_t side = std::min(ring, rings);
+    for (size_t k = 0; k < side; k++) {
+      row[k] -= ringStart(rows, cols, k) + rows - 1 - k - i;
+      const size_t h = rows - 1 - 2 * k, w = cols - 1 - 2 * k;
+      row[cols - 1 - k] -= ringStart(rows, cols, k) + h + w + i - k;
     }
-    for (size_t j = left; j < right; j++) {
-      matrix[j + top * cols] -= decrease_by;
-      decrease_by++;
+    if (ring >= rings) {
+      continue;
     }
-    for (size_t i = top; i < bot; i++) {
-      matrix[i * cols + right] -= decrease_by;
-      decrease_by++;
+    const size_t left = ring, right = cols - 1 - ring;
+    const size_t h = rows - 1 - 2 * ring, w = right - left;
+    const size_t start = ringStart(rows, cols, ring);
+    if (i == ring) {
+      for (size_t j = left; j < right; j++) {
+        row[j] -= start + h + j - left;
+      }
+      if (h != 0) {
+        row[right] -= start + h + w;
+      }
     }
-    for (size_t j = right; j > left; j--) {
-      matrix[bot * cols + j] -= decrease_by;
-      decrease_by++;
+    if (i == rows - 1 - ring) {
+      for (size_t j = left + 1; j <= right; j++) {
+        row[j] -= start + 2 * h + w + right - j;
+      }
+      if (h != 0) {
+        row[left] -= start;
+      }
     }
-    top++;
-    right--;
-    bot--;
-    left++;
   }
 }
+
+void hvostov::modifyMatrix(const Matrix & matrix)
+{
+  common::Phase phase("modifyMatrix", matrix.rows() * matrix.cols());
+  const size_t rows = matrix.rows(), cols = matrix.cols();
+  const size_t tiles = common::tileCount(rows, cols);
+  if (tiles <= 1) {
+    hvostov::modifyRows(matrix, 0, rows);
+    return;
+  }
+  common::ThreadPool::shared().run(tiles, [&](size_t tile) {
+    hvostov::modifyRows(matrix, rows * tile / tiles, rows * (tile + 1) / tiles);
+  });
+}
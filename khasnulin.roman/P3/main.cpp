@@ -4,6 +4,14 @@
 #include <istream>
 #include <ostream>
 #include <stdexcept>
+#include <vector>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <triangular.hpp>
+#include <spiral.hpp>
 
 namespace khasnulin
 {
@@ -17,9 +25,15 @@ namespace khasnulin
   bool lwrTriMtx(const int *arr, size_t n, size_t m);
 
   std::ostream &printMatrix(std::ostream &output, const int *a, size_t n, size_t m);
+  int run(int argc, char **argv);
 }
 
 int main(int argc, char **argv)
+{
+  return common::runBatch(argc, argv, khasnulin::run);
+}
+
+int khasnulin::run(int argc, char **argv)
 {
   size_t mode = 0;
   int *currArr = nullptr;
@@ -33,23 +47,30 @@ int main(int argc, char **argv)
   {
     mode = khasnulin::getFirstParameter(argv[1]);
 
-    std::ifstream input(argv[2]);
+    common::InputFile input(argv[2], mode == 3);
     size_t n = 1, m = 1;
 
     int arr[10000] = {};
 
-    input >> n >> m;
-    currArr = mode == 1 ? arr : new int[n * m];
-
     size_t elems_count = 0;
-    khasnulin::readMatrix(input, currArr, n, m, elems_count);
+    bool mapped = input.binaryMatrix(currArr, n, m);
+    if (mapped)
+    {
+      elems_count = n * m;
+    }
+    else
+    {
+      input >> n >> m;
+    }
+    common::Arena arena(mode != 1 && !mapped ? common::Arena::bytes< int >(n * m) : 0);
+    if (!mapped)
+    {
+      currArr = mode != 1 ? arena.allocateArray< int >(n * m) : arr;
+      khasnulin::readMatrix(input, currArr, n, m, elems_count);
+    }
 
     if ((!input.eof() && input.fail()) || (elems_count != n * m))
     {
-      if (mode == 2)
-      {
-        delete[] currArr;
-      }
       std::cerr << "Error while reading input file data, can't read as matrix\n";
       return 2;
     }
@@ -62,11 +83,6 @@ int main(int argc, char **argv)
 
     khasnulin::printMatrix(output, currArr, n, m);
     output << std::boolalpha << isLWR_TRI_MTX;
-
-    if (mode == 2)
-    {
-      delete[] currArr;
-    }
   }
   catch (const std::bad_alloc &e)
   {
@@ -75,22 +91,15 @@ int main(int argc, char **argv)
   }
   catch (const std::runtime_error &e)
   {
-    if (mode == 2)
-    {
-      delete[] currArr;
-    }
     std::cerr << e.what() << "\n";
     return 1;
   }
   catch (...)
   {
     std::cerr << "Error during task execution, something went wrong\n";
-    if (mode == 2)
-    {
-      delete[] currArr;
-    }
     return 2;
   }
+  return 0;
 }
 
 size_t khasnulin::getFirstParameter(const char *num)
@@ -112,88 +121,44 @@ size_t khasnulin::getFirstParameter(const char *num)
     {
       return 2;
     }
+    else if (num[0] == '3')
+    {
+      return 3;
+    }
   }
   throw std::runtime_error("Incorrect first parameter input\n");
 }
 
 void khasnulin::lftBotClk(int *arr, size_t n, size_t m)
 {
-  if (n > 0 && m > 0)
+  common::Phase phase("lftBotClk", n * m);
+  std::vector< unsigned > ranks(m);
+  for (size_t i = 0; i < n; i++)
   {
-    size_t currI = (n - 1) * m;
-
-    int directionI = -1;
-    int directionJ = 0;
-    int factor = 1;
-    size_t spiral_circle = 0;
-    size_t elem_counter = 0;
-    for (size_t i = 0; i < n * m; i++)
+    common::spiralRanks(common::SpiralOrder::bottom_left_clockwise, n, m, i, ranks.data());
+    int *row = arr + i * m;
+    for (size_t j = 0; j < m; j++)
     {
-      arr[currI] -= factor;
-      factor++;
-      elem_counter++;
-      if (directionI && elem_counter == (n - spiral_circle))
-      {
-        if (directionI == -1)
-        {
-          directionJ = 1;
-        }
-        else
-        {
-          directionJ = -1;
-        }
-        spiral_circle++;
-        elem_counter = 0;
-        directionI = 0;
-      }
-      else if (directionJ && elem_counter == (m - spiral_circle))
-      {
-        if (directionJ == -1)
-        {
-          directionI = -1;
-        }
-        else
-        {
-          directionI = 1;
-        }
-        elem_counter = 0;
-        directionJ = 0;
-      }
-      currI += directionI * m + directionJ;
+      row[j] -= ranks[j];
     }
   }
 }
 
 bool khasnulin::lwrTriMtx(const int *arr, size_t n, size_t m)
 {
+  common::Phase phase("lwrTriMtx", n * m);
   size_t minSide = std::min(n, m);
   if (minSide == 0)
   {
     return false;
   }
-  for (size_t i = 0; i < minSide; i++)
-  {
-    for (size_t j = i + 1; j < m; j++)
-    {
-      if (arr[i * m + j] != 0)
-      {
-        return false;
-      }
-    }
-  }
-
-  return true;
+  return common::zeroAboveDiagonal(arr, minSide, m, m);
 }
 
 using is_t = std::istream;
 is_t &khasnulin::readMatrix(is_t &input, int *arr, size_t n, size_t m, size_t &elems_count)
 {
-  elems_count = 0;
-  while ((elems_count < n * m) && (input >> arr[elems_count]))
-  {
-    elems_count++;
-  }
-
+  elems_count = common::readIntegers(input, arr, n * m);
   return input;
 }
 
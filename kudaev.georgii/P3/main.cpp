@@ -1,17 +1,55 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <vector>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <matrix_writer.hpp>
+#include <row_window.hpp>
+#include <spiral.hpp>
+#include <pipeline.hpp>
+#include <fixed_matrix.hpp>
+#include <gpu.hpp>
 
 namespace kudaev
 {
-  std::ifstream& inputMtx(std::ifstream&, int*, size_t, size_t);
+  std::istream& inputMtx(std::istream&, int*, size_t, size_t);
   void lftBotClk(int*, size_t, size_t);
+  void lftBotClkRows(int*, size_t, size_t, size_t, size_t);
+  template< size_t M, size_t N >
+  void lftBotClk(common::FixedMatrix< int, M, N >&);
+  template< size_t M, size_t N >
+  void processFixed(std::istream&, std::ostream&, common::FixedMatrix< int, M, N >&);
+  bool pipelineMtx(std::istream&, std::ostream&, int*, size_t, size_t, common::GpuMatrix&);
   int bldSmtMtr(std::ostream&, int*, size_t, size_t);
+  int bldSmtMtr(std::ostream&, int*, size_t, size_t, common::GpuMatrix&);
+  class SmtRowWriter
+  {
+  public:
+    explicit SmtRowWriter(common::BufferedWriter&);
+    void operator()(const int*, const int*, const int*, size_t);
+    void writeSums(const long long*, bool, bool, size_t);
+  private:
+    common::BufferedWriter& writer_;
+    std::vector< long long > columns_;
+    bool first_;
+    void writeCell(long long, int);
+  };
   void outputMtx(std::ostream&, const int*, size_t, size_t);
+  int run(int argc, char** argv);
 }
 
 int main(int argc, char** argv)
+{
+  return common::runBatch(argc, argv, kudaev::run);
+}
+
+int kudaev::run(int argc, char** argv)
 {
   if (argc < 4)
   {
@@ -29,7 +67,7 @@ int main(int argc, char** argv)
     return 1;
   }
   int choice = std::atoi(argv[1]);
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], choice == 3);
   std::ofstream output(argv[3]);
   if (!input.is_open())
   {
@@ -42,9 +80,10 @@ int main(int argc, char** argv)
     return 2;
   }
   int* target = nullptr;
-  int a[10000] = {};
+  int a[10000];
   size_t m, n;
-  if (!(input >> m >> n))
+  bool mapped = input.binaryMatrix(target, m, n);
+  if (!mapped && !(input >> m >> n))
   {
     std::cerr << "Error reading a file\n";
     return 2;
@@ -54,7 +93,8 @@ int main(int argc, char** argv)
     output << m << ' ' << n << '\n';
     return 0;
   }
-  else
+  common::Arena arena(!mapped && choice != 1 ? common::Arena::bytes< int >(m * n) : 0);
+  if (!mapped)
   {
     switch (choice)
     {
@@ -72,10 +112,11 @@ int main(int argc, char** argv)
       break;
     }
     case 2:
+    case 3:
     {
       try
       {
-        target = new int[m * n];
+        target = arena.allocateArray< int >(m * n);
       }
       catch (const std::exception& ex)
       {
@@ -91,15 +132,36 @@ int main(int argc, char** argv)
     }
     }
   }
+  common::GpuMatrix device;
   try
   {
-    if (!kudaev::inputMtx(input, target, m, n))
+    auto fixed = [&input, &output](auto& mtx)
+    {
+      kudaev::processFixed(input, output, mtx);
+    };
+    if (!mapped && choice == 1 && common::dispatchFixed< int, common::FIXED_SIDE >(m, n, fixed))
+    {
+      return 0;
+    }
+    if (!mapped && choice != 1)
     {
-      throw std::runtime_error("Can't read a file properly");
+      if (!kudaev::pipelineMtx(input, output, target, m, n, device))
+      {
+        output.close();
+        output.open(argv[3]);
+        throw std::runtime_error("Can't read a file properly");
+      }
+    }
+    else
+    {
+      if (!mapped && !kudaev::inputMtx(input, target, m, n))
+      {
+        throw std::runtime_error("Can't read a file properly");
+      }
+      kudaev::lftBotClk(target, m, n);
+      kudaev::outputMtx(output, target, m, n);
     }
-    kudaev::lftBotClk(target, m, n);
-    kudaev::outputMtx(output, target, m, n);
-    int res = kudaev::bldSmtMtr(output, target, m, n);
+    int res = kudaev::bldSmtMtr(output, target, m, n, device);
     if (res == 1)
     {
       throw std::runtime_error("Memory allocation failed in bldSmtMtr");
@@ -107,191 +169,216 @@ int main(int argc, char** argv)
   }
   catch (const std::exception& ex)
   {
-    if (choice == 2)
-    {
-      delete[] target;
-    }
     std::cerr << ex.what() << '\n';
     return 2;
   }
-  if (choice == 2 && target != nullptr)
-  {
-    delete[] target;
-  }
+  return 0;
 }
 
-std::ifstream& kudaev::inputMtx(std::ifstream& input, int* a, size_t m, size_t n)
+std::istream& kudaev::inputMtx(std::istream& input, int* a, size_t m, size_t n)
 {
-  for (size_t i = 0; i < m * n; ++i)
-  {
-    input >> a[i];
-  }
+  common::readMatrix(input, a, m, n);
   return input;
 }
 
 void kudaev::lftBotClk(int* a, size_t m, size_t n)
 {
-  size_t pos = (m - 1) * n;
-  size_t rows = m, cols = n;
-  int k = 1;
-  while (rows > 0 && cols > 0)
+  common::Phase phase("lftBotClk", m * n);
+  lftBotClkRows(a, m, n, 0, m);
+}
+
+void kudaev::lftBotClkRows(int* a, size_t m, size_t n, size_t begin, size_t end)
+{
+  std::vector< unsigned > ranks(n);
+  for (size_t i = begin; i < end; i++)
   {
-    for (size_t i = 0; i < rows; i++)
-    {
-      a[pos] -= k++;
-      if (i < rows - 1)
-      {
-        pos -= n;
-      }
-    }
-    if (--cols == 0)
-    {
-      break;
-    }
-    pos++;
-    for (size_t i = 0; i < cols; i++)
+    common::spiralRanks(common::SpiralOrder::bottom_left_clockwise, m, n, i, ranks.data());
+    int* row = a + i * n;
+    for (size_t j = 0; j < n; j++)
     {
-      a[pos] -= k++;
-      if (i < cols - 1)
-      {
-        pos++;
-      }
-    }
-    if (--rows == 0)
-    {
-      break;
-    }
-    pos += n;
-    for (size_t i = 0; i < rows; i++)
-    {
-      a[pos] -= k++;
-      if (i < rows - 1)
-      {
-        pos += n;
-      }
-    }
-    if (--cols == 0)
-    {
-      break;
-    }
-    pos--;
-    for (size_t i = 0; i < cols; i++)
-    {
-      a[pos] -= k++;
-      if (i < cols - 1)
-      {
-        pos--;
-      }
+      row[j] -= ranks[j];
     }
-    if (--rows == 0)
-    {
-      break;
-    }
-    pos -= n;
   }
 }
 
+template< size_t M, size_t N >
+void kudaev::lftBotClk(common::FixedMatrix< int, M, N >& a)
+{
+  common::Phase phase("lftBotClk", M * N);
+  static constexpr common::SpiralTable< M, N > spiral =
+      common::spiralTable< M, N >(common::SpiralOrder::bottom_left_clockwise);
+  int* values = a.data();
+  for (size_t k = 0; k < M * N; k++)
+  {
+    values[k] -= spiral.ranks[k];
+  }
+}
+
+template< size_t M, size_t N >
+void kudaev::processFixed(std::istream& input, std::ostream& output, common::FixedMatrix< int, M, N >& a)
+{
+  if (!kudaev::inputMtx(input, a.data(), M, N))
+  {
+    throw std::runtime_error("Can't read a file properly");
+  }
+  kudaev::lftBotClk(a);
+  kudaev::outputMtx(output, a.data(), M, N);
+  kudaev::bldSmtMtr(output, a.data(), M, N);
+}
+
 void kudaev::outputMtx(std::ostream& out, const int* a, size_t m, size_t n)
 {
-  out << m << ' ' << n << ' ';
-  for (size_t i = 0; i < m * n; ++i)
+  common::BufferedWriter writer(out);
+  writer << m << ' ' << n << ' ';
+  writer.write(a, m * n, ' ');
+  writer << '\n';
+}
+
+bool kudaev::pipelineMtx(std::istream& input, std::ostream& out, int* a, size_t m, size_t n,
+    common::GpuMatrix& device)
+{
+  if (common::gpuOffload(m * n))
+  {
+    device.allocate(m, n, n);
+  }
+  common::BufferedWriter writer(out);
+  writer << m << ' ' << n << ' ';
+  bool first = true;
+  auto transform = [m, n](int* mtx, size_t begin, size_t end)
+  {
+    common::Phase phase("lftBotClk", (end - begin) * n);
+    lftBotClkRows(mtx, m, n, begin, end);
+  };
+  auto emit = [&writer, &first, &device, a](const int* values, size_t count)
   {
-    if (i == m * n - 1)
+    device.upload(values - a, values, count);
+    if (!first)
     {
-      out << a[i];
-      break;
+      writer << ' ';
     }
-    out << a[i] << ' ';
+    first = false;
+    writer.write(values, count, ' ');
+  };
+  if (common::pipelineRows(input, a, m, n, transform, emit) != m * n)
+  {
+    return false;
   }
-  out << '\n';
+  writer << '\n';
+  return true;
 }
 
-int kudaev::bldSmtMtr(std::ostream& out, int* a, size_t m, size_t n)
+kudaev::SmtRowWriter::SmtRowWriter(common::BufferedWriter& writer):
+  writer_(writer),
+  columns_(),
+  first_(true)
+{}
+
+void kudaev::SmtRowWriter::operator()(const int* higherrow, const int* row, const int* lowerrow, size_t n)
 {
-  int* tmp = nullptr;
-  float* res_mas = nullptr;
-  try
+  columns_.resize(n);
+  long long* column = columns_.data();
+  for (size_t j = 0; j < n; ++j)
   {
-    tmp = new int[m * n];
-    res_mas = new float[m * n];
-    for (size_t i = 0; i < m * n; ++i)
-    {
-        tmp[i] = a[i];
-    }
-    for (size_t i = 0; i < m * n; ++i)
+    column[j] = row[j];
+  }
+  for (size_t j = 0; higherrow && j < n; ++j)
+  {
+    column[j] += higherrow[j];
+  }
+  for (size_t j = 0; lowerrow && j < n; ++j)
+  {
+    column[j] += lowerrow[j];
+  }
+  for (size_t j = 0; j < n; ++j)
+  {
+    const size_t left = j > 0 ? j - 1 : j;
+    const size_t right = j + 1 < n ? j + 1 : j;
+    const int width = static_cast< int >(right - left + 1);
+    const int k = width * ((higherrow ? 1 : 0) + (lowerrow ? 1 : 0)) + width - 1;
+    long long sum = -static_cast< long long >(row[j]);
+    for (size_t c = left; c <= right; ++c)
     {
-      int sum = 0;
-      int k = 0;
-      int higherrow = i - n;
-      size_t lowerrow = i + n;
-      if (higherrow >= 0)
-      {
-        sum += tmp[higherrow];
-        k++;
-        if (higherrow % n != 0)
-        {
-          sum += tmp[higherrow - 1];
-          k++;
-        }
-        if ((higherrow + 1) % n != 0)
-        {
-          sum += tmp[higherrow + 1];
-          k++;
-        }
-      }
-      if (lowerrow < m * n)
-      {
-        sum += tmp[lowerrow];
-        k++;
-        if (lowerrow % n != 0)
-        {
-          sum += tmp[lowerrow - 1];
-          k++;
-        }
-        if ((lowerrow + 1) % n != 0)
-        {
-          sum += tmp[lowerrow + 1];
-          k++;
-        }
-      }
-      if (i % n != 0)
-      {
-        sum += tmp[i - 1];
-        k++;
-      }
-      if ((i + 1) % n != 0)
-      {
-        sum += tmp[i + 1];
-        k++;
-      }
-      if (k == 0)
-      {
-        res_mas[i] = 0.0f;
-      }
-      else
-      {
-        float res = sum * 1.0 / k;
-        res_mas[i] = res;
-      }
+      sum += column[c];
     }
-    out << m << ' ' << n << ' ';
-    for (size_t i = 0; i < m * n; ++i)
+    writeCell(sum, k);
+  }
+}
+
+void kudaev::SmtRowWriter::writeSums(const long long* sums, bool higher, bool lower, size_t n)
+{
+  for (size_t j = 0; j < n; ++j)
+  {
+    const int width = (j > 0 ? 2 : 1) + (j + 1 < n ? 1 : 0);
+    writeCell(sums[j], width * ((higher ? 1 : 0) + (lower ? 1 : 0)) + width - 1);
+  }
+}
+
+void kudaev::SmtRowWriter::writeCell(long long sum, int k)
+{
+  const long long maxTenths = 100000;
+  if (!first_)
+  {
+    writer_ << ' ';
+  }
+  first_ = false;
+  long long tenths = 0;
+  if (k != 0)
+  {
+    const long long twice = 2ll * k;
+    const long long scaled = 20ll * sum + k;
+    tenths = scaled >= 0 ? scaled / twice : -((twice - 1 - scaled) / twice);
+  }
+  if (tenths < maxTenths && tenths > -maxTenths)
+  {
+    writer_.writeTenths(tenths);
+  }
+  else
+  {
+    float res = sum * 1.0 / k;
+    writer_ << static_cast< double >(std::floor(10 * res + 0.5f) / 10);
+  }
+}
+
+int kudaev::bldSmtMtr(std::ostream& out, int* a, size_t m, size_t n)
+{
+  common::GpuMatrix device;
+  return kudaev::bldSmtMtr(out, a, m, n, device);
+}
+
+int kudaev::bldSmtMtr(std::ostream& out, int* a, size_t m, size_t n, common::GpuMatrix& device)
+{
+  const size_t stripCells = 1 << 22;
+  common::Phase phase("bldSmtMtr", m * n);
+  common::BufferedWriter writer(out);
+  writer << m << ' ' << n << ' ';
+  SmtRowWriter rows(writer);
+  if (!device.valid() && common::gpuOffload(m * n) && device.allocate(m, n, n))
+  {
+    device.upload(0, a, m * n);
+  }
+  size_t done = 0;
+  if (device.valid())
+  {
+    const size_t strip = std::max< size_t >(1, stripCells / n);
+    std::vector< long long > sums(std::min(strip, m) * n);
+    while (done < m && device.windowSums(done, std::min(done + strip, m), sums.data()))
     {
-      if (i == m * n - 1)
+      const size_t end = std::min(done + strip, m);
+      for (size_t i = done; i < end; ++i)
       {
-        out << std::floor(10 * res_mas[i] + 0.5f) / 10;
-        break;
+        rows.writeSums(sums.data() + (i - done) * n, i > 0, i + 1 < m, n);
       }
-      out << std::floor(10 * res_mas[i] + 0.5f) / 10 << ' ';
+      done = end;
     }
-    delete[] tmp;
-    delete[] res_mas;
   }
-  catch (...)
+  if (done == 0)
   {
-    delete[] tmp;
-    delete[] res_mas;
-    return 1;
+    common::scanRows(a, m, n, rows);
+    return 0;
+  }
+  for (size_t i = done; i < m; ++i)
+  {
+    rows(a + (i - 1) * n, a + i * n, i + 1 < m ? a + (i + 1) * n : nullptr, n);
   }
   return 0;
 }
@@ -2,19 +2,51 @@
 #include <fstream>
 #include <memory>
 #include <cctype>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <row_window.hpp>
+#include <neighbourhood.hpp>
+#include <column_stats.hpp>
+#include <multi_query.hpp>
+#include <tiled_file.hpp>
+#include <narrow_matrix.hpp>
 
 namespace kuznetsov {
   const size_t MAX_SIZE = 10'000;
 
-  int getCntColNsm(const int* mtx, size_t rows, size_t cols);
-  int getCntLocMax(const int* mtx, size_t rows, size_t cols);
+  template< class T >
+  using Counters = common::MultiQuery< common::ColumnRepeats< T >, common::LocalMaxCounter< T > >;
+  using RowCounters = Counters< int >;
+
+  template< class T >
+  Counters< T > makeCounters(size_t rows, size_t cols);
+  template< class T >
+  int cntColNsm(const Counters< T >& counters);
+  template< class T >
+  int cntLocMax(const Counters< T >& counters);
 
   std::istream& initMatr(std::istream& input, int* mtx, size_t rows, size_t cols);
 
   int processMatrix(std::istream& input, int* mtx, size_t rows, size_t cols, const char* out);
+  int processNarrow(std::istream& input, size_t rows, size_t cols, const char* out);
+  int streamMatrix(std::istream& input, size_t rows, size_t cols, const char* out);
+  int streamTiles(common::TiledFile& tiles, size_t rows, size_t cols, const char* out);
+  template< class T >
+  int writeResults(const T* mtx, size_t rows, size_t cols, const char* out);
+  template< class T >
+  int writeCounters(const Counters< T >& counters, const char* out);
+  int run(int argc, char** argv);
 }
 
 int main(int argc, char** argv)
+{
+  return common::runBatch(argc, argv, kuznetsov::run);
+}
+
+int kuznetsov::run(int argc, char** argv)
 {
   namespace kuz = kuznetsov;
   if (argc < 4) {
@@ -26,90 +58,74 @@ int main(int argc, char** argv)
   } else if (!std::isdigit(argv[1][0])) {
     std::cerr << "First parameter is not a number\n";
     return 1;
-  } else if ((argv[1][0] != '1' && argv[1][0] != '2') || argv[1][1] != '\0') {
+  } else if ((argv[1][0] < '1' || argv[1][0] > '4') || argv[1][1] != '\0') {
     std::cerr << "First parameter is out of range\n";
     return 1;
   }
 
   size_t rows = 0, cols = 0;
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], argv[1][0] == '3');
 
   if (!input.is_open()) {
     std::cerr << "Can't open file\n";
     return 2;
   }
 
+  common::TiledFile tiles;
+  if (argv[1][0] == '4' && tiles.open(argv[2]) && tiles.binaryMatrix(common::ElementType::int32, rows, cols)) {
+    return kuz::streamTiles(tiles, rows, cols, argv[3]);
+  }
+  int* mtrx = nullptr;
+  if (input.binaryMatrix(mtrx, rows, cols)) {
+    return kuz::writeResults(mtrx, rows, cols, argv[3]);
+  }
   input >> rows >> cols;
   if (!input) {
     std::cerr << "Bad reading size\n";
     return 2;
   }
+  if (argv[1][0] == '4') {
+    return kuz::streamMatrix(input, rows, cols, argv[3]);
+  }
+  if (argv[1][0] == '2') {
+    return kuz::processNarrow(input, rows, cols, argv[3]);
+  }
   int mtx[kuz::MAX_SIZE] {};
-  int* mtrx = nullptr;
-  int* mt = nullptr;
+  common::Arena arena(argv[1][0] == '1' ? 0 : common::Arena::bytes< int >(rows * cols));
   if (argv[1][0] == '1') {
     mtrx = mtx;
   } else {
-    mt = reinterpret_cast< int* >(malloc(sizeof(int) * rows * cols));
-    if (mt == nullptr) {
+    mtrx = arena.allocate< int >(rows * cols);
+    if (mtrx == nullptr) {
       std::cerr << "Bad alloc\n";
       return 3;
     }
-    mtrx = mt;
   }
-  int statusExit = kuz::processMatrix(input, mtrx, rows, cols, argv[3]);
-  free(mt);
-  return statusExit;
+  return kuz::processMatrix(input, mtrx, rows, cols, argv[3]);
 }
 
-int kuznetsov::getCntColNsm(const int* mtx, size_t rows, size_t cols)
+template< class T >
+kuznetsov::Counters< T > kuznetsov::makeCounters(size_t rows, size_t cols)
 {
-  if (rows == 0 || cols == 0) {
-    return 0;
-  }
-  int res = 0;
-  for (size_t j = 0; j < cols; ++j) {
-    bool repeats = false;
-    for (size_t i = 0; i < rows - 1; ++i) {
-      if (mtx[i * cols + j] == mtx[(i + 1) * cols + j]) {
-        repeats = true;
-        break;
-      }
-    }
-    res += !repeats;
-  }
-  return res;
+  const size_t counted = rows == 0 ? 0 : cols;
+  return common::makeQueries(common::ColumnRepeats< T >(counted), common::LocalMaxCounter< T >());
 }
 
-int kuznetsov::getCntLocMax(const int* mtx, size_t rows, size_t cols)
+template< class T >
+int kuznetsov::cntColNsm(const Counters< T >& counters)
 {
-  if (rows == 0 || cols == 0) {
-    return 0;
-  }
-  int res = 0;
-  for (size_t j = 1; j < cols - 1; ++j) {
-    for (size_t i = 1; i < rows - 1; ++i) {
-      int center = mtx[i * cols + j];
-      bool isLocMax = true;
-      for (int di = -1; di <= 1; ++di) {
-        for (int dj = -1; dj <= 1; ++dj) {
-          if (!(di == 0 && dj == 0)) {
-            isLocMax = isLocMax && (center > mtx[(i + di) * cols + j + dj]);
-          }
-        }
-      }
-      res += isLocMax;
-    }
-  }
-  return res;
+  return counters.template get< 0 >().distinct();
+}
+
+template< class T >
+int kuznetsov::cntLocMax(const Counters< T >& counters)
+{
+  return counters.template get< 1 >().count();
 }
 
 std::istream& kuznetsov::initMatr(std::istream& input, int* mtx, size_t rows, size_t cols)
 {
-  for (size_t i = 0; input && i < rows * cols; ++i) {
-    input >> mtx[i];
-  }
-  return input;
+  return common::readMatrix(input, mtx, rows, cols);
 }
 
 int kuznetsov::processMatrix(std::istream& input, int* mtx, size_t rows, size_t cols, const char* out)
@@ -122,13 +138,71 @@ int kuznetsov::processMatrix(std::istream& input, int* mtx, size_t rows, size_t
     std::cerr << "Bad read\n";
     return 2;
   }
+  return writeResults(mtx, rows, cols, out);
+}
 
-  int res1 = getCntColNsm(mtx, rows, cols);
-  int res2 = getCntLocMax(mtx, rows, cols);
+int kuznetsov::processNarrow(std::istream& input, size_t rows, size_t cols, const char* out)
+{
+  common::NarrowMatrix narrow(rows, cols);
+  try {
+    narrow.read(input);
+  } catch (const std::bad_alloc&) {
+    std::cerr << "Bad alloc\n";
+    return 3;
+  }
+  if (input.eof()) {
+    std::cerr << "Not enough elements for matrix\n";
+    return 1;
+  } else if (input.fail()) {
+    std::cerr << "Bad read\n";
+    return 2;
+  }
+  int result = 0;
+  narrow.visit([&result, out](const auto& view) {
+    result = writeResults(view.row(0), view.rows(), view.cols(), out);
+  });
+  return result;
+}
 
+int kuznetsov::streamMatrix(std::istream& input, size_t rows, size_t cols, const char* out)
+{
+  RowCounters counters = makeCounters< int >(rows, cols);
+  common::streamRows< int >(input, rows, cols, counters);
+  if (input.eof()) {
+    std::cerr << "Not enough elements for matrix\n";
+    return 1;
+  } else if (input.fail()) {
+    std::cerr << "Bad read\n";
+    return 2;
+  }
+  return writeCounters(counters, out);
+}
+
+int kuznetsov::streamTiles(common::TiledFile& tiles, size_t rows, size_t cols, const char* out)
+{
+  RowCounters counters = makeCounters< int >(rows, cols);
+  if (tiles.scanRows< int >(rows, cols, counters) != rows * cols) {
+    std::cerr << "Bad read\n";
+    return 2;
+  }
+  return writeCounters(counters, out);
+}
+
+template< class T >
+int kuznetsov::writeResults(const T* mtx, size_t rows, size_t cols, const char* out)
+{
+  common::Phase phase("cntColNsm+cntLocMax", rows * cols);
+  Counters< T > counters = makeCounters< T >(rows, cols);
+  common::scanQueries(mtx, rows, cols, counters);
+  return writeCounters(counters, out);
+}
+
+template< class T >
+int kuznetsov::writeCounters(const Counters< T >& counters, const char* out)
+{
   std::ofstream output(out);
-  output << res1 << '\n';
-  output << res2 << '\n';
+  output << cntColNsm(counters) << '\n';
+  output << cntLocMax(counters) << '\n';
 
   return 0;
 }
@@ -1,16 +1,34 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <row_window.hpp>
+#include <neighbourhood.hpp>
+#include <multi_query.hpp>
+#include <triangular.hpp>
+#include <tiled_file.hpp>
 
 namespace rizatdinov
 {
-  bool initial(int * array, size_t len, std::ifstream & file);
-  bool isLocalMax(const int * array, size_t cols, size_t position);
-  unsigned long countLocalMax(const int * array, size_t rows, size_t cols);
-  bool isLowerTriangular(const int * array, size_t rows, size_t cols);
+  using RowStats = common::MultiQuery< common::CrossMaxCounter< int >, common::ZeroAboveDiagonal< int > >;
+
+  bool initial(int * array, size_t len, std::istream & file);
+  RowStats makeStats();
+  unsigned long countLocalMax(const RowStats & stats);
+  bool isLowerTriangular(const RowStats & stats, size_t rows, size_t cols);
+  int run(int argc, char ** argv);
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, rizatdinov::run);
+}
+
+int rizatdinov::run(int argc, char ** argv)
 {
   if (argc < 4 || argc > 4) {
     std::cerr << "fatal: invalid parameters\n";
@@ -18,30 +36,49 @@ int main(int argc, char ** argv)
   }
 
   char number = argv[1][0];
-  if (number < '1' || number > '2' || argv[1][1] != '\0') {
+  if (number < '1' || number > '4' || argv[1][1] != '\0') {
     std::cerr << "fatal: invalid parameters\n";
     return 1;
   }
 
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], number == '3');
   if (!input) {
     std::cerr << "fatal: file not found\n";
     return 2;
   }
 
   size_t rows = 0, cols = 0;
-  input >> rows >> cols;
+  int * array = nullptr;
+  common::TiledFile tiles;
+  bool tiled = number == '4' && tiles.open(argv[2]) && tiles.binaryMatrix(common::ElementType::int32, rows, cols);
+  bool mapped = !tiled && input.binaryMatrix(array, rows, cols);
+  if (!mapped && !tiled) {
+    input >> rows >> cols;
+  }
   if (!input) {
     std::cerr << "fatal: could not read file\n";
     return 2;
   }
 
-  int * array = nullptr;
+  if (number == '4') {
+    rizatdinov::RowStats stats = rizatdinov::makeStats();
+    const size_t done = tiled ? tiles.scanRows< int >(rows, cols, stats) : common::streamRows< int >(input, rows, cols, stats);
+    if (done != rows * cols) {
+      std::cerr << "fatal: could not read file\n";
+      return 2;
+    }
+    input.close();
+    std::ofstream output(argv[3]);
+    output << rizatdinov::countLocalMax(stats) << ' ' << rizatdinov::isLowerTriangular(stats, rows, cols) << '\n';
+    return 0;
+  }
+
   int fixlen_array[10000] = {};
-  if (number == '1') {
+  common::Arena arena(!mapped && number != '1' ? common::Arena::bytes< int >(rows * cols) : 0);
+  if (!mapped && number == '1') {
     array = fixlen_array;
-  } else {
-    array = reinterpret_cast< int * >(malloc(sizeof(int) * rows * cols));
+  } else if (!mapped) {
+    array = arena.allocate< int >(rows * cols);
   }
 
   if (array == nullptr) {
@@ -49,10 +86,7 @@ int main(int argc, char ** argv)
     return 3;
   }
 
-  if (rizatdinov::initial(array, rows * cols, input)) {
-    if (number == '2') {
-      free(array);
-    }
+  if (!mapped && rizatdinov::initial(array, rows * cols, input)) {
     std::cerr << "fatal: could not read file\n";
     return 2;
   }
@@ -61,64 +95,38 @@ int main(int argc, char ** argv)
 
   std::ofstream output(argv[3]);
 
-  size_t count_local_max = rizatdinov::countLocalMax(array, rows, cols);
-  bool is_lower_triangular = rizatdinov::isLowerTriangular(array, rows, cols);
+  rizatdinov::RowStats stats = rizatdinov::makeStats();
+  {
+    common::Phase phase("countLocalMax+isLowerTriangular", rows * cols);
+    common::scanQueries(array, rows, cols, stats);
+  }
+  size_t count_local_max = rizatdinov::countLocalMax(stats);
+  bool is_lower_triangular = rizatdinov::isLowerTriangular(stats, rows, cols);
 
   output << count_local_max << ' ' << is_lower_triangular << '\n';
 
-  if (number == '2') {
-    free(array);
-  }
-
   return 0;
 }
 
-bool rizatdinov::initial(int * array, size_t len, std::ifstream & file)
+bool rizatdinov::initial(int * array, size_t len, std::istream & file)
 {
-  for (size_t i = 0; i < len; ++i) {
-    file >> array[i];
-    if (!file) {
-      return 1;
-    }
-  }
-  return 0;
+  return common::readIntegers(file, array, len) != len;
 }
 
-bool rizatdinov::isLocalMax(const int * array, size_t cols, size_t position)
+rizatdinov::RowStats rizatdinov::makeStats()
 {
-  bool result = array[position] > array[position + 1];
-  result = result && array[position] > array[position - 1];
-  result = result && array[position] > array[position + cols];
-  result = result && array[position] > array[position - cols];
-
-  return result;
+  return common::makeQueries(common::CrossMaxCounter< int >(), common::ZeroAboveDiagonal< int >());
 }
 
-unsigned long rizatdinov::countLocalMax(const int * array, size_t rows, size_t cols)
+unsigned long rizatdinov::countLocalMax(const RowStats & stats)
 {
-  size_t count = 0;
-  for (size_t i = 1; i + 1 < rows; ++i) {
-    for (size_t j = 1; j + 1 < cols; ++j) {
-      size_t position = i * cols + j;
-      count += rizatdinov::isLocalMax(array, cols, position);
-    }
-  }
-  return count;
+  return stats.get< 0 >().count();
 }
 
-bool rizatdinov::isLowerTriangular(const int * array, size_t rows, size_t cols)
+bool rizatdinov::isLowerTriangular(const RowStats & stats, size_t rows, size_t cols)
 {
   if (!(rows && cols)) {
     return false;
   }
-
-  bool result = true;
-  for (size_t i = 0; i < rows; ++i) {
-    for (size_t j = i + 1; j < cols; ++j) {
-      if (array[i * cols + j] != 0) {
-        return false;
-      }
-    }
-  }
-  return result;
+  return stats.get< 1 >().zero();
 }
@@ -2,6 +2,15 @@
 #include <cstddef>
 #include <limits>
 #include <fstream>
+#include <vector>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <row_window.hpp>
+#include <column_stats.hpp>
+#include <rings.hpp>
 
 namespace sedov
 {
@@ -9,9 +18,16 @@ namespace sedov
   void convertIncMatrix(int * mtx, size_t rows, size_t cols);
   size_t getNumCol(const int * mtx, size_t rows, size_t cols);
   size_t completeMatrix(std::istream & input, int * mtx, size_t rows, size_t cols, const char * out);
+  size_t writeResults(int * mtx, size_t rows, size_t cols, const char * out);
+  int run(int argc, char ** argv);
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, sedov::run);
+}
+
+int sedov::run(int argc, char ** argv)
 {
   if (argc < 4)
   {
@@ -23,14 +39,19 @@ int main(int argc, char ** argv)
     std::cerr << "Too many arguments\n";
     return 1;
   }
-  else if ((argv[1][0] != '1' && argv[1][0] != '2') || argv[1][1] != '\0')
+  else if ((argv[1][0] < '1' || argv[1][0] > '3') || argv[1][1] != '\0')
   {
     std::cerr << "First parameter is out of range\n";
     return 1;
   }
 
   size_t r = 0, c = 0;
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], argv[1][0] == '3');
+  int * mapped = nullptr;
+  if (input.binaryMatrix(mapped, r, c))
+  {
+    return sedov::writeResults(mapped, r, c, argv[3]);
+  }
   input >> r >> c;
   if (!input)
   {
@@ -47,10 +68,9 @@ int main(int argc, char ** argv)
 
   try
   {
-    int * matrix = new int[r * c];
-    size_t st = sedov::completeMatrix(input, matrix, r, c, argv[3]);
-    delete[] matrix;
-    return st;
+    common::Arena arena(common::Arena::bytes< int >(r * c));
+    int * matrix = arena.allocateArray< int >(r * c);
+    return sedov::completeMatrix(input, matrix, r, c, argv[3]);
   }
   catch (const std::bad_alloc & e)
   {
@@ -61,36 +81,34 @@ int main(int argc, char ** argv)
 
 std::istream & sedov::inputMatrix(std::istream & input, int * mtx, size_t rows, size_t cols)
 {
-  for (size_t i = 0; i < rows * cols; ++i)
-  {
-    input >> mtx[i];
-  }
-  return input;
+  return common::readMatrix(input, mtx, rows, cols);
 }
 
 void sedov::convertIncMatrix(int * mtx, size_t rows, size_t cols)
 {
-  size_t minrc = std::min(rows, cols);
-  size_t layer = minrc / 2 + minrc % 2;
-  const int MAX = std::numeric_limits< int >::max();
-  for (size_t k = 0; k < layer; ++k)
+  common::Phase phase("convertIncMatrix", rows * cols);
+  const size_t half = cols / 2 + cols % 2;
+  std::vector< int > steps(cols);
+  for (size_t i = 0; i < rows; ++i)
   {
-    for (size_t i = k; i < rows - k; ++i)
+    int * row = mtx + i * cols;
+    common::ringSteps(rows, cols, i, steps.data());
+    if (!common::addStepsChecked(row, steps.data(), half))
     {
-      for (size_t j = k; j < cols - j; ++j)
-      {
-        if (mtx[i * cols + j] > MAX - 1)
-        {
-          throw std::overflow_error("Increment matrix overflow");
-        }
-        mtx[i * cols + j] += 1;
-      }
+      throw std::overflow_error("Increment matrix overflow");
     }
   }
 }
 
 size_t sedov::getNumCol(const int * mtx, size_t rows, size_t cols)
 {
+  common::Phase phase("getNumCol", rows * cols);
+  if (rows <= static_cast< size_t >(std::numeric_limits< int >::max()))
+  {
+    common::ColumnRuns runs(cols);
+    common::scanRows(mtx, rows, cols, runs);
+    return runs.longest();
+  }
   size_t maxLength = 0, maxCol = 0;
   for (size_t j = 0; j < cols; ++j)
   {
@@ -130,6 +148,11 @@ size_t sedov::completeMatrix(std::istream & input, int * mtx, size_t rows, size_
     }
     return 2;
   }
+  return writeResults(mtx, rows, cols, out);
+}
+
+size_t sedov::writeResults(int * mtx, size_t rows, size_t cols, const char * out)
+{
   size_t res1 = getNumCol(mtx, rows, cols);
   try
   {
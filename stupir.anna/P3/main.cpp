@@ -1,77 +1,38 @@
 #include <iostream>
 #include <fstream>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <matrix_writer.hpp>
+#include <diagonals.hpp>
+#include <spiral.hpp>
+#include <row_window.hpp>
+#include <tiled_file.hpp>
+#include <cstdio>
+#include <vector>
 
 namespace stupir
 {
-  bool checkAddSnail(size_t up, size_t down, size_t left, size_t right)
+  void addSnail(int * arr, size_t rows, size_t cols)
   {
-    return (up <= down && left <= right);
-  }
-
-  void addSnail(const int * arr1, size_t rows, size_t cols, int * arr2)
-  {
-    size_t sum = 1;
-    size_t left = 0;
-    size_t right = cols - 1;
-    size_t up = 0;
-    size_t down = rows - 1;
-    while (checkAddSnail(up, down, left, right))
+    common::Phase phase("addSnail", rows * cols);
+    std::vector< unsigned > ranks(cols);
+    for (size_t i = 0; i < rows; ++i)
     {
-      for (size_t i = left; i < right + 1; ++i)
-      {
-        arr2[cols * down + i] += sum + arr1[cols * down + i];
-        sum++;
-      }
-      down--;
-
-      if (!checkAddSnail(up, down, left, right))
-      {
-        break;
-      }
-
-      for (size_t i = down; i > up ; --i)
-      {
-        arr2[cols * i + right] += sum + arr1[cols * i + right];
-        sum++;
-      }
-      arr2[cols * up + right] += sum + arr1[cols * up + right];
-      sum++;
-      right--;
-
-      if (!checkAddSnail(up, down, left, right))
-      {
-        break;
-      }
-
-      for (size_t i = right; i > left; --i)
-      {
-        arr2[up * cols + i] += sum + arr1[up * cols + i];
-        sum++;
-      }
-      arr2[up * cols + left] += sum + arr1[up * cols + left];
-      sum++;
-      up++;
-
-      if (!checkAddSnail(up, down, left, right))
-      {
-        break;
-      }
-
-      for (size_t i = up; i < down + 1; ++i)
+      common::spiralRanks(common::SpiralOrder::bottom_left_counterclockwise, rows, cols, i, ranks.data());
+      int * row = arr + cols * i;
+      for (size_t j = 0; j < cols; ++j)
       {
-        arr2[cols * i + left] += sum + arr1[cols * i + left];
-        sum++;
+        row[j] += ranks[j];
       }
-      left++;
     }
   }
 
-  std::ifstream & readArr(std::ifstream & input, size_t rows, size_t cols, int * arr)
+  std::istream & readArr(std::istream & input, size_t rows, size_t cols, int * arr)
   {
-    for (size_t i = 0; i < rows * cols; ++i)
-    {
-      input >> arr[i];
-    }
+    common::readMatrix(input, arr, rows, cols);
     return input;
   }
 
@@ -79,11 +40,8 @@ namespace stupir
   {
     if (!output.fail())
     {
-      output << arr[0];
-      for (size_t i = 1; i < rows * cols; ++i)
-      {
-        output << " " << arr[i];
-      }
+      common::BufferedWriter writer(output);
+      writer.write(arr, rows * cols, ' ');
     }
     else
     {
@@ -91,54 +49,102 @@ namespace stupir
     }
   }
 
-  size_t countNotZeroD(const int * arr, size_t rows, size_t cols)
+  size_t countNotZeroD(const common::DiagonalStats & diagonals)
   {
     size_t result = 0;
+    for (size_t d = 0; d < diagonals.size(); ++d)
+    {
+      result += diagonals.mainZeros(d) == 0;
+    }
+    return result;
+  }
+
+  size_t countNotZeroD(const int * arr, size_t rows, size_t cols)
+  {
+    common::Phase phase("countNotZeroD", rows * cols);
     if (rows == 0 && cols == 0)
     {
       return 0;
     }
-    for (size_t k = 0; k < rows; ++k)
+    if (rows == 0 || cols == 0)
     {
-      size_t num = 0;
-      for (size_t i = 0; i < rows; ++i)
+      return rows + (cols != 0 ? cols - 1 : 0);
+    }
+    return countNotZeroD(common::scanDiagonals(arr, rows, cols));
+  }
+
+  class SnailRows
+  {
+  public:
+    SnailRows(common::BufferedWriter & writer, common::DiagonalStats & diagonals, size_t rows, size_t cols):
+      writer_(writer),
+      diagonals_(diagonals),
+      rows_(rows),
+      row_(0),
+      ranks_(cols),
+      values_(cols)
+    {}
+
+    void operator()(const int *, const int * row, const int *, size_t cols)
+    {
+      diagonals_.addRow(row_, row);
+      common::spiralRanks(common::SpiralOrder::bottom_left_counterclockwise, rows_, cols, row_, ranks_.data());
+      for (size_t j = 0; j < cols; ++j)
       {
-        if (i - k < cols)
-        {
-          if (arr[cols * i + i - k] == 0)
-          {
-            num++;
-          }
-        }
+        values_[j] = row[j] + ranks_[j];
       }
-      if (num == 0)
+      if (row_++ != 0)
       {
-        result++;
+        writer_ << ' ';
       }
+      writer_.write(values_.data(), cols, ' ');
     }
 
-    for (size_t k = 1; k < cols; ++k)
+  private:
+    common::BufferedWriter & writer_;
+    common::DiagonalStats & diagonals_;
+    size_t rows_;
+    size_t row_;
+    std::vector< unsigned > ranks_;
+    std::vector< int > values_;
+  };
+
+  template< class Scan >
+  int streamArr(Scan scan, size_t rows, size_t cols, const char * path)
+  {
+    std::ofstream output(path);
+    common::DiagonalStats diagonals(rows, cols);
+    bool read = true;
     {
-      size_t num = 0;
-      for (size_t i = 0; i < rows; ++i)
-      {
-        if (i + k < cols)
-        {
-          if (arr[cols * i + i + k] == 0)
-          {
-            num++;
-          }
-        }
-      }
-      if (num == 0)
+      common::Phase phase("countNotZeroD+addSnail", rows * cols);
+      common::BufferedWriter writer(output);
+      writer << rows << ' ' << cols;
+      if (rows != 0 && cols != 0)
       {
-        result++;
+        writer << ' ';
+        SnailRows snail(writer, diagonals, rows, cols);
+        read = scan(snail);
       }
     }
-    return result;
+    if (!read)
+    {
+      output.close();
+      std::remove(path);
+      std::cerr << "Non-correct values of matrix elements\n";
+      return 2;
+    }
+    output << "\n" << countNotZeroD(diagonals);
+    return 0;
   }
+
+  int run(int argc, char ** argv);
 }
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, stupir::run);
+}
+
+int stupir::run(int argc, char ** argv)
 {
   const char * firstArg = argv[1];
   const char * secondArg = argv[2];
@@ -154,13 +160,13 @@ int main(int argc, char ** argv)
     std::cerr << "Too many arguments\n";
     return 1;
   }
-  else if ((firstArg[0] != '1' && firstArg[0] != '2') || firstArg[1] != '\0')
+  else if ((firstArg[0] < '1' || firstArg[0] > '4') || firstArg[1] != '\0')
   {
     std::cerr << "First parametr out of range\n";
     return 1;
   }
 
-  std::ifstream input(secondArg);
+  common::InputFile input(secondArg, firstArg[0] == '3');
   if (!input.is_open())
   {
     std::cerr << "Error when opening a file\n";
@@ -169,22 +175,52 @@ int main(int argc, char ** argv)
 
   size_t rows = 0;
   size_t cols = 0;
-  input >> rows;
-  input >> cols;
+  int * matrixFile = nullptr;
+  common::TiledFile tiles;
+  if (firstArg[0] == '4' && tiles.open(secondArg) && tiles.binaryMatrix(common::ElementType::int32, rows, cols))
+  {
+    if ((rows == 0 && cols) || (rows && cols == 0))
+    {
+      std::cerr << "Irregular matrix sizes\n";
+      return 2;
+    }
+    return stupir::streamArr([&tiles, rows, cols](stupir::SnailRows & snail)
+    {
+      return tiles.scanRows< int >(rows, cols, snail) == rows * cols;
+    }, rows, cols, thirdArg);
+  }
+  bool mapped = input.binaryMatrix(matrixFile, rows, cols);
+  if (!mapped)
+  {
+    input >> rows;
+    input >> cols;
+  }
   if (input.fail() || (rows == 0 && cols) || (rows && cols == 0))
   {
     std::cerr << "Irregular matrix sizes\n";
     return 2;
   }
 
+  if (!mapped && firstArg[0] == '4')
+  {
+    return stupir::streamArr([&input, rows, cols](stupir::SnailRows & snail)
+    {
+      common::streamRows< int >(input, rows, cols, snail);
+      return !input.fail();
+    }, rows, cols, thirdArg);
+  }
+
   const size_t maxStat = 10000;
-  int * matrixFile = nullptr;
-  int * matrixChange = nullptr;
   size_t numDigNotNull = 0;
   namespace stu = stupir;
+  common::Arena arena(!mapped && firstArg[0] != '1' ? common::Arena::bytes< int >(rows * cols) : 0);
   try
   {
-    if (firstArg[0] == '1')
+    if (mapped)
+    {
+      input.close();
+    }
+    else if (firstArg[0] == '1')
     {
       if (rows * cols <= maxStat)
       {
@@ -198,30 +234,23 @@ int main(int argc, char ** argv)
     }
     else
     {
-      matrixFile = new int[rows * cols]();
+      matrixFile = arena.allocateArray< int >(rows * cols);
     }
 
-    if (!stu::readArr(input, rows, cols, matrixFile))
+    if (!mapped && !stu::readArr(input, rows, cols, matrixFile))
     {
       std::cerr << "Non-correct values of matrix elements\n";
-      if (firstArg[0] == '2')
-      {
-        delete [] matrixFile;
-      }
       return 2;
     }
     input.close();
-    matrixChange = new int[rows * cols]();
+    numDigNotNull = stu::countNotZeroD(matrixFile, rows, cols);
     if (rows != 0 && cols != 0)
     {
-      stu::addSnail(matrixFile, rows, cols, matrixChange);
+      stu::addSnail(matrixFile, rows, cols);
     }
-    numDigNotNull = stu::countNotZeroD(matrixFile, rows, cols);
   }
   catch (const std::bad_alloc & e)
   {
-    delete [] matrixFile;
-    delete [] matrixChange;
     std::cerr << "Not enough memory\n";
     return 2;
   }
@@ -229,17 +258,12 @@ int main(int argc, char ** argv)
   if (rows != 0 && cols != 0)
   {
     output << rows << " " << cols << " ";
-    stu::writeArr(output, rows, cols, matrixChange);
+    stu::writeArr(output, rows, cols, matrixFile);
   }
   else
   {
     output << rows << " " << cols;
   }
   output << "\n" << numDigNotNull;
-
-  if (firstArg[0] == '2')
-  {
-    delete [] matrixFile;
-  }
-  delete [] matrixChange;
+  return 0;
 }
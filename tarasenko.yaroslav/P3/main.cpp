@@ -1,67 +1,57 @@
 #include <iostream>
 #include <fstream>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <padded_matrix.hpp>
+#include <row_window.hpp>
+#include <neighbourhood.hpp>
+#include <multi_query.hpp>
+#include <tiled_file.hpp>
 
 namespace tarasenko
 {
   std::istream & input(std::istream & in, int * arr, size_t n, size_t m, size_t & k)
   {
-    for (size_t i = 0; i < n * m; ++i)
-    {
-      in >> arr[i];
-      if (!in)
-      {
-        return in;
-      }
-      k += 1;
-    }
+    k += common::readIntegers(in, arr, n * m);
     return in;
   }
 
-  size_t cnt_loc_extremum(int const * arr, int type, size_t n, size_t m)
+  std::istream & input(std::istream & in, common::PaddedMatrix< int > & arr, size_t & k)
   {
-    if (n * m == 0)
-    {
-      return 0;
-    }
-    size_t count = 0;
-    for (size_t i = 1; i < n - 1; ++i)
-    {
-      for (size_t k = 1; k < m - 1; ++k)
-      {
-        bool is_extremum = true;
-        const int num = arr[i * m + k];
-        for (int near_i = -1; near_i < 2; ++near_i)
-        {
-          for (int near_k = -1; near_k < 2; ++near_k)
-          {
-            if (!(near_i == 0 && near_k == 0))
-            {
-              const int near_num = arr[(i + near_i) * m + (k + near_k)];
-              if ((type && num <= near_num) || (!type && num >= near_num))
-              {
-                is_extremum = false;
-              }
-            }
-          }
-        }
-        count += (is_extremum ? 1 : 0);
-      }
-    }
-    return count;
+    k += common::readIntegers(in, arr);
+    return in;
+  }
+
+  using Extrema = common::MultiQuery< common::LocalMaxCounter< int >, common::LocalMinCounter< int > >;
+
+  Extrema cnt_loc_extrema(const common::MatrixView< const int > & arr)
+  {
+    common::Phase phase("cnt_loc_extrema", arr.rows() * arr.cols());
+    Extrema counters = common::makeQueries(common::LocalMaxCounter< int >(), common::LocalMinCounter< int >());
+    common::scanQueries(arr, counters);
+    return counters;
   }
 
-  size_t cnt_loc_max(int const * arr, size_t n, size_t m)
+  size_t cnt_loc_max(const Extrema & counters)
   {
-    return cnt_loc_extremum(arr, 1, n, m);
+    return counters.get< 0 >().count();
   }
 
-  size_t cnt_loc_min(int const * arr, size_t n, size_t m)
+  size_t cnt_loc_min(const Extrema & counters)
   {
-    return cnt_loc_extremum(arr, 0, n, m);
+    return counters.get< 1 >().count();
   }
+  int run(int argc, char ** argv);
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, tarasenko::run);
+}
+
+int tarasenko::run(int argc, char ** argv)
 {
   if (argc < 4)
   {
@@ -74,15 +64,23 @@ int main(int argc, char ** argv)
     return 1;
   }
   const char * first_arg = argv[1];
-  if ((first_arg[0] != '1' && first_arg[0] != '2') || first_arg[1] != '\0')
+  if ((first_arg[0] < '1' || first_arg[0] > '4') || first_arg[1] != '\0')
   {
     std::cerr << "First parameter is out of range\n";
     return 1;
   }
 
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], first_arg[0] == '3');
   size_t rows = 0, cols = 0;
-  input >> rows >> cols;
+  int * arr = nullptr;
+  common::TiledFile tiles;
+  bool is_tiled = first_arg[0] == '4' && tiles.open(argv[2])
+      && tiles.binaryMatrix(common::ElementType::int32, rows, cols);
+  bool is_mapped = !is_tiled && input.binaryMatrix(arr, rows, cols);
+  if (!is_mapped && !is_tiled)
+  {
+    input >> rows >> cols;
+  }
   if (!input)
   {
     std::cerr << "Incorrect file" << '\n';
@@ -96,41 +94,77 @@ int main(int argc, char ** argv)
     return 0;
   }
 
-  int fixed_arr[10000] = {};
-  int * arr = nullptr;
-  bool is_dynamic = (*argv[1] == '2') ? 1 : 0;
-  if (!is_dynamic)
+  if (first_arg[0] == '4')
   {
-    arr = fixed_arr;
+    tarasenko::Extrema counter = common::makeQueries(common::LocalMaxCounter< int >(),
+        common::LocalMinCounter< int >());
+    size_t k = 0;
+    if (is_tiled)
+    {
+      k = tiles.scanRows< int >(rows, cols, counter);
+    }
+    else
+    {
+      k = common::streamRows< int >(input, rows, cols, counter);
+    }
+    if (!input || k != rows * cols)
+    {
+      std::cerr << "Managed to read " << k << " numbers from file" << '\n';
+      return 2;
+    }
+    input.close();
+    std::ofstream output(argv[3]);
+    output << tarasenko::cnt_loc_max(counter) << '\n';
+    output << tarasenko::cnt_loc_min(counter) << '\n';
+    return 0;
   }
-  else
+
+  if (*argv[1] != '1' && !is_mapped)
   {
-    arr = reinterpret_cast< int * >(malloc(sizeof(int) * rows * cols));
-    if (!arr)
+    common::PaddedMatrix< int > padded(rows, cols);
+    if (!padded.allocated())
     {
       std::cerr << "failed to allocate memory" << '\n';
       return 1;
     }
+    size_t k = 0;
+    tarasenko::input(input, padded, k);
+    if (!input)
+    {
+      std::cerr << "Managed to read " << k << " numbers from file" << '\n';
+      return 2;
+    }
+    input.close();
+    tarasenko::Extrema counters = tarasenko::cnt_loc_extrema(padded.view());
+    size_t max = tarasenko::cnt_loc_max(counters);
+    size_t min = tarasenko::cnt_loc_min(counters);
+    std::ofstream output(argv[3]);
+    output << max << '\n';
+    output << min << '\n';
+    return 0;
+  }
+
+  int fixed_arr[10000] = {};
+  if (!is_mapped)
+  {
+    arr = fixed_arr;
   }
   size_t k = 0;
-  tarasenko::input(input, arr, rows, cols, k);
+  if (!is_mapped)
+  {
+    tarasenko::input(input, arr, rows, cols, k);
+  }
   if (!input)
   {
     std::cerr << "Managed to read " << k << " numbers from file" << '\n';
-    if (is_dynamic)
-    {
-      free(arr);
-    }
     return 2;
   }
   input.close();
-  size_t max = tarasenko::cnt_loc_max(arr, rows, cols);
-  size_t min = tarasenko::cnt_loc_min(arr, rows, cols);
+  tarasenko::Extrema counters = tarasenko::cnt_loc_extrema(common::MatrixView< const int >(arr, rows, cols));
+  size_t max = tarasenko::cnt_loc_max(counters);
+  size_t min = tarasenko::cnt_loc_min(counters);
   std::ofstream output(argv[3]);
   output << max << '\n';
   output << min << '\n';
-  if (is_dynamic)
-  {
-    free(arr);
-  }
+  return 0;
 }
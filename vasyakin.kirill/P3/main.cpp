@@ -2,6 +2,19 @@
 #include <cstddef>
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <matrix_writer.hpp>
+#include <spiral.hpp>
+#include <row_window.hpp>
+#include <column_stats.hpp>
+#include <parallel.hpp>
+#include <tiled_file.hpp>
 namespace vasyakin
 {
   void outputMatrix(const int* a, size_t rows, size_t cols, std::ofstream& output);
@@ -9,104 +22,64 @@ namespace vasyakin
   void transformSpiral(int* a, size_t rows, size_t cols);
   std::istream& readMatrix(int* a, size_t rows, size_t cols, std::istream& input);
   size_t completeMatrix(std::istream& input, int* matrix, size_t rows, size_t cols, std::ofstream& output);
+  size_t writeResults(int* matrix, size_t rows, size_t cols, std::ofstream& output);
+  size_t streamMatrix(std::istream& input, const char* path, size_t rows, size_t cols, std::ofstream& output);
+  size_t streamTiles(common::TiledFile& tiles, size_t rows, size_t cols, std::ofstream& output);
+  class SpiralRowWriter
+  {
+  public:
+    SpiralRowWriter(common::BufferedWriter& writer, size_t rows, size_t cols);
+    void operator()(const int* above, const int* row, const int* below, size_t cols);
+  private:
+    common::BufferedWriter& writer_;
+    size_t rows_;
+    size_t row_;
+    std::vector< unsigned > ranks_;
+    std::vector< int > values_;
+  };
+  int run(int argc, char** argv);
 }
 void vasyakin::outputMatrix(const int* a, size_t rows, size_t cols, std::ofstream& output)
 {
-  output << rows << ' ' << cols << '\n';
+  common::BufferedWriter writer(output);
+  writer << rows << ' ' << cols << '\n';
   if (rows != 0 && cols != 0)
   {
     for (size_t i = 0; i < rows; ++i)
     {
-      output << a[i * cols + 0];
-      for (size_t j = 1; j < cols; ++j)
-      {
-        output << ' ' << a[i * cols + j];
-      }
-      output << '\n';
+      writer.write(a + i * cols, cols, ' ');
+      writer << '\n';
     }
   }
 }
 int vasyakin::countSaddlePoints(const int* a, size_t rows, size_t cols)
 {
-  int count = 0;
-  for (size_t i = 0; i < rows; ++i)
+  common::Phase phase("countSaddlePoints", rows * cols);
+  if (rows == 0 || cols == 0)
   {
-    for (size_t j = 0; j < cols; ++j)
-    {
-      int current = a[i * cols + j];
-      bool is_min_in_row = true;
-      bool is_max_in_col = true;
-      for (size_t f = 0; f < cols; ++f)
-      {
-        if (a[i * cols + f] < current)
-        {
-          is_min_in_row = false;
-          break;
-        }
-      }
-      for (size_t f = 0; f < rows; ++f)
-      {
-        if (a[f * cols + j] > current)
-        {
-          is_max_in_col = false;
-          break;
-        }
-      }
-      if (is_min_in_row && is_max_in_col)
-      {
-        count++;
-      }
-    }
+    return 0;
   }
-  return count;
+  common::SaddlePoints saddles(cols);
+  common::parallelScanRows(a, rows, cols, saddles);
+  return saddles.count();
 }
 void vasyakin::transformSpiral(int* a, size_t rows, size_t cols)
 {
-  size_t circle = std::min(rows, cols) / 2 + std::min(rows, cols) % 2;
-  size_t subtrahend = 1;
-  for (size_t k = 0; k < circle; ++k)
+  common::Phase phase("transformSpiral", rows * cols);
+  std::vector< unsigned > ranks(cols);
+  for (size_t i = 0; i < rows; ++i)
   {
-    for (size_t i = k; i < cols - k; ++i)
-    {
-      a[k * cols + i] -= subtrahend;
-      subtrahend++;
-    }
-    for (size_t i = k + 1; i < rows - k; ++i)
-    {
-      a[i * cols + (cols - 1 - k)] -= subtrahend;
-      subtrahend++;
-    }
-    if (k < rows - k - 1)
-    {
-      for (size_t i = cols - k - 2; i + 1 > k; --i)
-      {
-        a[(rows - 1 - k) * cols + i] -= subtrahend;
-        subtrahend++;
-      }
-    }
-    if (k < cols - k - 1)
+    common::spiralRanks(common::SpiralOrder::top_left_clockwise, rows, cols, i, ranks.data());
+    int* row = a + i * cols;
+    for (size_t j = 0; j < cols; ++j)
     {
-      for (size_t i = rows - k - 2; i > k; --i)
-      {
-        a[i * cols + k] -= subtrahend;
-        subtrahend++;
-      }
+      row[j] -= ranks[j];
     }
   }
 }
 std::istream& vasyakin::readMatrix(int* a, size_t rows, size_t cols, std::istream& input)
 {
-  for (size_t i = 0; i < rows; ++i)
-  {
-    for (size_t j = 0; j < cols; ++j)
-    {
-      if (!(input >> a[i * cols + j]))
-      {
-        return input;
-      }
-    }
-  }
-  return input;
+  return common::readMatrix(input, a, rows, cols);
 }
 size_t vasyakin::completeMatrix(std::istream& input, int* matrix, size_t rows, size_t cols, std::ofstream& output)
 {
@@ -122,26 +95,107 @@ size_t vasyakin::completeMatrix(std::istream& input, int* matrix, size_t rows, s
     }
     return 2;
   }
+  return vasyakin::writeResults(matrix, rows, cols, output);
+}
+size_t vasyakin::writeResults(int* matrix, size_t rows, size_t cols, std::ofstream& output)
+{
   size_t res = vasyakin::countSaddlePoints(matrix, rows, cols);
   output << res << '\n';
   vasyakin::transformSpiral(matrix, rows, cols);
   vasyakin::outputMatrix(matrix, rows, cols, output);
   return 0;
 }
+size_t vasyakin::streamMatrix(std::istream& input, const char* path, size_t rows, size_t cols, std::ofstream& output)
+{
+  common::SaddlePoints saddles(cols);
+  {
+    common::Phase phase("countSaddlePoints", rows * cols);
+    common::streamRows< int >(input, rows, cols, saddles);
+  }
+  if (!input)
+  {
+    if (input.eof())
+    {
+      std::cerr << "Not enough arguments for matrix" << '\n';
+    }
+    else if (input.fail())
+    {
+      std::cerr << "Unexpected input" << '\n';
+    }
+    return 2;
+  }
+  output << (rows == 0 || cols == 0 ? 0 : saddles.count()) << '\n';
+  common::InputFile again(path, false);
+  again >> rows >> cols;
+  common::BufferedWriter writer(output);
+  writer << rows << ' ' << cols << '\n';
+  if (rows != 0 && cols != 0)
+  {
+    common::Phase phase("transformSpiral", rows * cols);
+    vasyakin::SpiralRowWriter spiral(writer, rows, cols);
+    common::streamRows< int >(again, rows, cols, spiral);
+  }
+  return 0;
+}
+size_t vasyakin::streamTiles(common::TiledFile& tiles, size_t rows, size_t cols, std::ofstream& output)
+{
+  common::SaddlePoints saddles(cols);
+  if (rows != 0 && cols != 0)
+  {
+    common::Phase phase("countSaddlePoints", rows * cols);
+    if (tiles.scanRows< int >(rows, cols, saddles) != rows * cols)
+    {
+      std::cerr << "Unexpected input" << '\n';
+      return 2;
+    }
+  }
+  output << (rows == 0 || cols == 0 ? 0 : saddles.count()) << '\n';
+  common::BufferedWriter writer(output);
+  writer << rows << ' ' << cols << '\n';
+  if (rows != 0 && cols != 0)
+  {
+    common::Phase phase("transformSpiral", rows * cols);
+    vasyakin::SpiralRowWriter spiral(writer, rows, cols);
+    tiles.scanRows< int >(rows, cols, spiral);
+  }
+  return 0;
+}
+vasyakin::SpiralRowWriter::SpiralRowWriter(common::BufferedWriter& writer, size_t rows, size_t cols):
+  writer_(writer),
+  rows_(rows),
+  row_(0),
+  ranks_(cols),
+  values_(cols)
+{}
+void vasyakin::SpiralRowWriter::operator()(const int*, const int* row, const int*, size_t cols)
+{
+  common::spiralRanks(common::SpiralOrder::top_left_clockwise, rows_, cols, row_++, ranks_.data());
+  for (size_t j = 0; j < cols; ++j)
+  {
+    values_[j] = row[j] - ranks_[j];
+  }
+  writer_.write(values_.data(), cols, ' ');
+  writer_ << '\n';
+}
 int main(int argc, char** argv)
+{
+  return common::runBatch(argc, argv, vasyakin::run);
+}
+
+int vasyakin::run(int argc, char** argv)
 {
   if (argc != 4)
   {
     std::cerr << (argc < 4 ? "Not enough arguments" : "Too many arguments") << '\n';
     return 1;
   }
-  if ((argv[1][0] != '1' && argv[1][0] != '2') || argv[1][1] != '\0')
+  if ((argv[1][0] < '1' || argv[1][0] > '4') || argv[1][1] != '\0')
   {
-    std::cerr << "First parameter must be 1 or 2" << "\n";
+    std::cerr << "First parameter must be 1, 2, 3 or 4" << "\n";
     return 1;
   }
   int num = argv[1][0] - '0';
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], num == 3);
   std::ofstream output(argv[3]);
   if (!input)
   {
@@ -156,11 +210,25 @@ int main(int argc, char** argv)
   try
   {
     size_t rows = 0, cols = 0;
+    int* mapped = nullptr;
+    common::TiledFile tiles;
+    if (num == 4 && tiles.open(argv[2]) && tiles.binaryMatrix(common::ElementType::int32, rows, cols))
+    {
+      return vasyakin::streamTiles(tiles, rows, cols, output);
+    }
+    if (input.binaryMatrix(mapped, rows, cols))
+    {
+      return vasyakin::writeResults(mapped, rows, cols, output);
+    }
     if (!(input >> rows >> cols))
     {
       std::cerr << "cannot read matrix dimensions" << "\n";
       return 2;
     }
+    if (num == 4)
+    {
+      return vasyakin::streamMatrix(input, argv[2], rows, cols, output);
+    }
     if (num == 1)
     {
       if (rows * cols > 10000)
@@ -174,10 +242,9 @@ int main(int argc, char** argv)
     }
     else
     {
-      int* matrix = new int [rows * cols];
-      size_t k = vasyakin::completeMatrix(input, matrix, rows, cols, output);
-      delete[] matrix;
-      return k;
+      common::Arena arena(common::Arena::bytes< int >(rows * cols));
+      int* matrix = arena.allocateArray< int >(rows * cols);
+      return vasyakin::completeMatrix(input, matrix, rows, cols, output);
     }
   }
   catch (const std::exception& e)
@@ -2,16 +2,58 @@
 #include <fstream>
 #include <memory>
 #include <cctype>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <column_stats.hpp>
+#include <parallel.hpp>
+#include <triangular.hpp>
+#include <sparse_matrix.hpp>
+#include <row_window.hpp>
+#include <multi_query.hpp>
+#include <tiled_file.hpp>
 
 namespace zharov
 {
+  class UpperTriangleRows
+  {
+  public:
+    UpperTriangleRows(size_t rows, size_t cols);
+    void operator()(size_t i, const int * above, const int * row, const int * below, size_t cols);
+    void merge(const UpperTriangleRows & other);
+    bool upper() const;
+
+  private:
+    size_t side_;
+    bool upper_;
+  };
+
+  using RowStats = common::MultiQuery< UpperTriangleRows, common::ColumnRepeats< int > >;
+
   std::istream & inputMatrix(std::istream & input, int * mtx, size_t rows, size_t cols);
   bool isUppTriMtx(const int * mtx, size_t rows, size_t cols);
+  bool isUppTriMtx(const common::SparseMatrix & mtx, size_t rows, size_t cols);
   size_t getCntColNsm(const int * mtx, size_t rows, size_t cols);
-  void processMatrix(std::ifstream & input, int * matrix, size_t rows, size_t cols, const char * output_file);
+  size_t getCntColNsm(const common::SparseMatrix & mtx, size_t rows, size_t cols);
+  void processMatrix(std::istream & input, int * matrix, size_t rows, size_t cols, const char * output_file);
+  void processSparse(std::istream & input, size_t rows, size_t cols, const char * output_file);
+  void processStream(std::istream & input, size_t rows, size_t cols, const char * output_file);
+  bool processTiles(common::TiledFile & tiles, size_t rows, size_t cols, const char * output_file);
+  RowStats makeStats(size_t rows, size_t cols);
+  void writeResults(const RowStats & stats, size_t rows, size_t cols, const char * output_file);
+  void writeResults(const int * matrix, size_t rows, size_t cols, const char * output_file);
+  void writeResults(const common::SparseMatrix & matrix, size_t rows, size_t cols, const char * output_file);
+  int run(int argc, char ** argv);
 }
 
 int main(int argc, char ** argv)
+{
+  return common::runBatch(argc, argv, zharov::run);
+}
+
+int zharov::run(int argc, char ** argv)
 {
   if (argc < 4) {
     std::cerr << "Not enough arguments\n";
@@ -25,13 +67,26 @@ int main(int argc, char ** argv)
     std::cerr << "First parameter is not a number\n";
     return 1;
   }
-  if ((argv[1][0] != '1' && argv[1][0] != '2') || argv[1][1] != '\0') {
+  if ((argv[1][0] < '1' || argv[1][0] > '5') || argv[1][1] != '\0') {
     std::cerr << "First parameter is out of range\n";
     return 1;
   }
 
   size_t rows = 0, cols = 0;
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], argv[1][0] == '3');
+  common::TiledFile tiles;
+  if (argv[1][0] == '4' && tiles.open(argv[2]) && tiles.binaryMatrix(common::ElementType::int32, rows, cols)) {
+    if (!zharov::processTiles(tiles, rows, cols, argv[3])) {
+      std::cerr << "Bad read (wrong value)\n";
+      return 2;
+    }
+    return 0;
+  }
+  int * mapped = nullptr;
+  if (input.binaryMatrix(mapped, rows, cols)) {
+    zharov::writeResults(mapped, rows, cols, argv[3]);
+    return 0;
+  }
   input >> rows >> cols;
   if (!input) {
     std::cerr << "Bad read (rows and cols)\n";
@@ -40,20 +95,25 @@ int main(int argc, char ** argv)
   constexpr size_t MAX_MATRIX_SIZE = 10000;
   int matrix_static[MAX_MATRIX_SIZE] = {};
   int * matrix = nullptr;
-  int * matrix_dynamic = nullptr;
-  if (argv[1][0] == '1') {
+  const bool sparse = argv[1][0] == '5';
+  const bool streamed = argv[1][0] == '4';
+  common::Arena arena(argv[1][0] == '1' || sparse || streamed ? 0 : common::Arena::bytes< int >(rows * cols));
+  if (sparse) {
+    zharov::processSparse(input, rows, cols, argv[3]);
+  } else if (streamed) {
+    zharov::processStream(input, rows, cols, argv[3]);
+  } else if (argv[1][0] == '1') {
     matrix = matrix_static;
   } else {
-    matrix_dynamic = reinterpret_cast< int * >(malloc(sizeof(int) * rows * cols));
-    if (matrix_dynamic == nullptr) {
+    matrix = arena.allocate< int >(rows * cols);
+    if (matrix == nullptr) {
       std::cerr << "Bad alloc\n";
       return 2;
     }
-    matrix = matrix_dynamic;
   }
-  zharov::processMatrix(input, matrix, rows, cols, argv[3]);
-
-  free(matrix_dynamic);
+  if (!sparse && !streamed) {
+    zharov::processMatrix(input, matrix, rows, cols, argv[3]);
+  }
 
   if (input.eof()) {
     std::cerr << "Not enough numbers\n";
@@ -62,19 +122,50 @@ int main(int argc, char ** argv)
     std::cerr << "Bad read (wrong value)\n";
     return 2;
   }
+  return 0;
+}
 
+zharov::UpperTriangleRows::UpperTriangleRows(size_t rows, size_t cols):
+  side_(std::min(rows, cols)),
+  upper_(side_ != 0)
+{}
+
+void zharov::UpperTriangleRows::operator()(size_t i, const int *, const int * row, const int *, size_t cols)
+{
+  const size_t begin = i * cols;
+  const size_t end = std::min(begin + cols, side_ * side_);
+  for (size_t flat = begin; upper_ && flat < end; flat = flat / side_ * side_ + side_) {
+    const size_t below = std::min(flat / side_ * side_ + flat / side_, end);
+    if (flat < below && !common::allZero(row + (flat - begin), below - flat)) {
+      upper_ = false;
+    }
+  }
+}
+
+void zharov::UpperTriangleRows::merge(const UpperTriangleRows & other)
+{
+  upper_ = upper_ && other.upper_;
+}
+
+bool zharov::UpperTriangleRows::upper() const
+{
+  return upper_;
+}
+
+zharov::RowStats zharov::makeStats(size_t rows, size_t cols)
+{
+  const size_t counted = rows == 0 ? 0 : cols;
+  return common::makeQueries(UpperTriangleRows(rows, cols), common::ColumnRepeats< int >(counted));
 }
 
 std::istream & zharov::inputMatrix(std::istream & input, int * mtx, size_t rows, size_t cols)
 {
-  for (size_t i = 0; input && i < rows * cols; ++i) {
-    input >> mtx[i];
-  }
-  return input;
+  return common::readMatrix(input, mtx, rows, cols);
 }
 
 bool zharov::isUppTriMtx(const int * mtx, size_t rows, size_t cols)
 {
+  common::Phase phase("isUppTriMtx", rows * cols);
   if (rows != cols) {
     rows = std::min(rows, cols);
     cols = rows;
@@ -83,10 +174,26 @@ bool zharov::isUppTriMtx(const int * mtx, size_t rows, size_t cols)
   if (rows == 0) {
     return false;
   }
+  return common::zeroBelowDiagonal(mtx, rows, cols, cols);
+}
 
+bool zharov::isUppTriMtx(const common::SparseMatrix & mtx, size_t rows, size_t cols)
+{
+  common::Phase phase("isUppTriMtx", mtx.nonzeros());
+  const size_t side = std::min(rows, cols);
+  if (side == 0) {
+    return false;
+  }
+  if (rows == cols) {
+    return common::zeroBelowDiagonal(mtx, rows, cols);
+  }
   for (size_t i = 0; i < rows; ++i) {
-    for (size_t j = 0; j < i; ++j) {
-      if (mtx[cols * i + j] != 0) {
+    for (size_t k = mtx.rowBegin(i); k < mtx.rowEnd(i); ++k) {
+      const size_t flat = i * cols + mtx.column(k);
+      if (flat >= side * side) {
+        return true;
+      }
+      if (flat % side < flat / side) {
         return false;
       }
     }
@@ -96,29 +203,81 @@ bool zharov::isUppTriMtx(const int * mtx, size_t rows, size_t cols)
 
 size_t zharov::getCntColNsm(const int * mtx, size_t rows, size_t cols)
 {
+  common::Phase phase("getCntColNsm", rows * cols);
   if (rows == 0 || cols == 0) {
     return 0;
   }
 
-  size_t res = cols;
-  for (size_t i = 0; i < cols; ++i) {
-    for (size_t j = 1; j < rows; ++j) {
-      if (mtx[j * cols + i] == mtx[(j - 1) * cols + i]) {
-        --res;
-        break;
-      }
-    }
+  common::ColumnRepeats< int > repeats(cols);
+  common::parallelScanRows(mtx, rows, cols, repeats);
+  return repeats.distinct();
+}
+
+size_t zharov::getCntColNsm(const common::SparseMatrix & mtx, size_t rows, size_t cols)
+{
+  common::Phase phase("getCntColNsm", mtx.nonzeros());
+  if (rows == 0 || cols == 0) {
+    return 0;
   }
-  return res;
+  return common::distinctColumns(mtx, rows, cols);
 }
 
-void zharov::processMatrix(std::ifstream & input, int * matrix, size_t rows, size_t cols, const char * output_file)
+void zharov::processMatrix(std::istream & input, int * matrix, size_t rows, size_t cols, const char * output_file)
 {
   zharov::inputMatrix(input, matrix, rows, cols);
   if (input.fail()) {
     return;
   }
+  zharov::writeResults(matrix, rows, cols, output_file);
+}
+
+void zharov::writeResults(const int * matrix, size_t rows, size_t cols, const char * output_file)
+{
+  std::ofstream output(output_file);
+  output << zharov::isUppTriMtx(matrix, rows, cols) << "\n";
+  output << zharov::getCntColNsm(matrix, rows, cols) << "\n";
+}
+
+void zharov::processSparse(std::istream & input, size_t rows, size_t cols, const char * output_file)
+{
+  common::SparseMatrix matrix(cols);
+  common::readSparse(input, matrix, rows);
+  if (input.fail()) {
+    return;
+  }
+  zharov::writeResults(matrix, rows, cols, output_file);
+}
+
+void zharov::writeResults(const common::SparseMatrix & matrix, size_t rows, size_t cols, const char * output_file)
+{
   std::ofstream output(output_file);
   output << zharov::isUppTriMtx(matrix, rows, cols) << "\n";
   output << zharov::getCntColNsm(matrix, rows, cols) << "\n";
 }
+
+void zharov::processStream(std::istream & input, size_t rows, size_t cols, const char * output_file)
+{
+  zharov::RowStats stats = zharov::makeStats(rows, cols);
+  common::streamRows< int >(input, rows, cols, stats);
+  if (input.fail()) {
+    return;
+  }
+  zharov::writeResults(stats, rows, cols, output_file);
+}
+
+bool zharov::processTiles(common::TiledFile & tiles, size_t rows, size_t cols, const char * output_file)
+{
+  zharov::RowStats stats = zharov::makeStats(rows, cols);
+  if (tiles.scanRows< int >(rows, cols, stats) != rows * cols) {
+    return false;
+  }
+  zharov::writeResults(stats, rows, cols, output_file);
+  return true;
+}
+
+void zharov::writeResults(const RowStats & stats, size_t rows, size_t cols, const char * output_file)
+{
+  std::ofstream output(output_file);
+  output << stats.get< 0 >().upper() << "\n";
+  output << (rows == 0 || cols == 0 ? 0 : stats.get< 1 >().distinct()) << "\n";
+}
@@ -2,19 +2,60 @@
 #include <fstream>
 #include <memory>
 #include <limits>
+#include <matrix_reader.hpp>
+#include <input_file.hpp>
+#include <batch.hpp>
+#include <phase.hpp>
+#include <arena.hpp>
+#include <matrix_writer.hpp>
+#include <column_stats.hpp>
+#include <parallel.hpp>
+#include <diagonals.hpp>
+#include <matrix_view.hpp>
+#include <sparse_matrix.hpp>
+#include <row_window.hpp>
+#include <multi_query.hpp>
+#include <tiled_file.hpp>
+#include <narrow_matrix.hpp>
 
 namespace zubarev
 {
+  using SquareStats = common::MultiQuery< common::ColumnRepeats< int >, common::DiagonalStats >;
+
+  class LeadingSquare
+  {
+  public:
+    LeadingSquare(SquareStats& stats, size_t side);
+    void operator()(const int* above, const int* row, const int* below, size_t cols);
+
+  private:
+    SquareStats& stats_;
+    size_t side_;
+    size_t row_;
+  };
+
   int getMaxInt();
   int getMinInt();
   std::ostream& outputMatrix(std::ostream& out, const int* matrix, size_t rows, size_t cols);
-  int* convertToSquare(int* matrix, size_t& rows, size_t& cols);
+  common::MatrixView< const int > convertToSquare(const int* matrix, size_t rows, size_t cols);
   int* readMatrix(std::istream& in, size_t& rows, size_t& cols, int* matrix);
-  int getCouOfColNoIden(const int* matrix, size_t rows, size_t cols);
-  int getMaxSumInDia(const int* matrix, size_t rows, size_t cols);
+  template< class T >
+  int getCouOfColNoIden(const common::MatrixView< const T >& matrix);
+  template< class T >
+  long long getMaxSumInDia(const common::MatrixView< const T >& matrix);
+  int getCouOfColNoIden(const common::SparseMatrix& matrix, size_t side);
+  long long getMaxSumInDia(const common::SparseMatrix& matrix, size_t side);
+  long long getMaxSumInDia(const common::DiagonalStats& diagonals, size_t side);
+  SquareStats makeSquareStats(size_t side);
+  int run(int argc, char** argv);
+}
+
+int main(int argc, char** argv)
+{
+  return common::runBatch(argc, argv, zubarev::run);
 }
 
-int main(int argc, char const** argv)
+int zubarev::run(int argc, char** argv)
 {
   namespace zub = zubarev;
   size_t rows = 0, cols = 0;
@@ -25,24 +66,84 @@ int main(int argc, char const** argv)
   } else if (argc < 4) {
     std::cerr << "Not enough arguments" << "\n";
     return 1;
-  } else if (std::stoi(argv[1]) > 2) {
+  } else if (std::stoi(argv[1]) > 5) {
     std::cerr << "First is out of range" << "\n";
     return 1;
   }
 
 
-  std::ifstream input(argv[2]);
+  common::InputFile input(argv[2], std::stoi(argv[1]) == 3);
   if (!input) {
     std::cerr << "Cannot open input file\n";
     return 1;
   }
-  input >> rows >> cols;
+  int* mtx = nullptr;
+  common::TiledFile tiles;
+  bool tiled = std::stoi(argv[1]) == 4 && tiles.open(argv[2])
+      && tiles.binaryMatrix(common::ElementType::int32, rows, cols);
+  bool mapped = !tiled && input.binaryMatrix(mtx, rows, cols);
+  if (!mapped && !tiled) {
+    input >> rows >> cols;
+  }
   if (!(input)) {
     std::cerr << "Can't read the file\n";
     return 1;
   }
-  int* mtx = nullptr;
-  if (std::stoi(argv[1]) == 1) {
+  if (std::stoi(argv[1]) == 4) {
+    const size_t side = std::min(rows, cols);
+    SquareStats stats = zub::makeSquareStats(side);
+    if (tiled) {
+      if (tiles.scanRows< int >(side, side, stats) != side * side) {
+        std::cerr << "Can't read the file\n";
+        return 1;
+      }
+    } else {
+      LeadingSquare square(stats, side);
+      common::streamRows< int >(input, rows, cols, square);
+      if (input.fail()) {
+        std::cerr << "Can't read the file\n";
+        return 1;
+      }
+    }
+    std::ofstream output(argv[3]);
+    output << static_cast< int >(stats.get< 0 >().distinct()) << "\n";
+    output << zub::getMaxSumInDia(stats.get< 1 >(), side) << "\n";
+    return 0;
+  }
+  if (std::stoi(argv[1]) == 5) {
+    common::SparseMatrix sparse(cols);
+    common::readSparse(input, sparse, rows);
+    if (input.fail()) {
+      std::cerr << "Can't read the file\n";
+      return 1;
+    }
+    const size_t side = std::min(rows, cols);
+    std::ofstream output(argv[3]);
+    output << zub::getCouOfColNoIden(sparse, side) << "\n";
+    output << zub::getMaxSumInDia(sparse, side) << "\n";
+    return 0;
+  }
+  if (!mapped && std::stoi(argv[1]) == 2) {
+    common::NarrowMatrix narrow(rows, cols);
+    try {
+      narrow.read(input);
+    } catch (const std::bad_alloc&) {
+      std::cerr << "Memory allocation failed\n";
+      return 1;
+    }
+    if (input.fail()) {
+      std::cerr << "Can't read the file\n";
+      return 1;
+    }
+    std::ofstream output(argv[3]);
+    narrow.visit([&output](const auto& matrix) {
+      output << zub::getCouOfColNoIden(matrix.square()) << "\n";
+      output << zub::getMaxSumInDia(matrix.square()) << "\n";
+    });
+    return 0;
+  }
+  common::Arena arena(!mapped && std::stoi(argv[1]) >= 3 ? common::Arena::bytes< int >(rows * cols) : 0);
+  if (!mapped && std::stoi(argv[1]) == 1) {
     int statMatrix[10000];
     if (rows * cols > 10000) {
       std::cerr << "Matrix too big for static allocation\n";
@@ -55,17 +156,15 @@ int main(int argc, char const** argv)
       return 1;
     }
 
-  } else if (std::stoi(argv[1]) == 2) {
-    mtx = reinterpret_cast<int*>(std::malloc(rows * cols * sizeof(int)));
+  } else if (!mapped && std::stoi(argv[1]) >= 2) {
+    mtx = arena.allocate< int >(rows * cols);
     if (!mtx) {
       std::cerr << "Memory allocation failed\n";
       return 1;
     }
-
     mtx = zub::readMatrix(input, rows, cols, mtx);
      if (input.fail()) {
       std::cerr << "Can't read the file\n";
-      free(mtx);
       return 1;
     }
   }
@@ -73,15 +172,31 @@ int main(int argc, char const** argv)
   if (!mtx) {
     return 2;
   }
-  int* square = zubarev::convertToSquare(mtx, rows, cols);
+  common::MatrixView< const int > square = zubarev::convertToSquare(mtx, rows, cols);
 
   std::ofstream output(argv[3]);
-  output << zub::getCouOfColNoIden(square, rows, cols) << "\n";
-  output << zub::getMaxSumInDia(square, rows, cols) << "\n";
-  if (std::stoi(argv[1]) == 2) {
-    free(mtx);
+  output << zub::getCouOfColNoIden(square) << "\n";
+  output << zub::getMaxSumInDia(square) << "\n";
+  return 0;
+}
+
+zubarev::LeadingSquare::LeadingSquare(SquareStats& stats, size_t side):
+  stats_(stats),
+  side_(side),
+  row_(0)
+{}
+
+void zubarev::LeadingSquare::operator()(const int* above, const int* row, const int* below, size_t)
+{
+  if (row_ < side_) {
+    stats_(above, row, row_ + 1 < side_ ? below : nullptr, side_);
   }
-  free(square);
+  ++row_;
+}
+
+zubarev::SquareStats zubarev::makeSquareStats(size_t side)
+{
+  return common::makeQueries(common::ColumnRepeats< int >(side), common::DiagonalStats(side, side));
 }
 
 int zubarev::getMaxInt()
@@ -100,97 +215,62 @@ int zubarev::getMinInt()
 
 std::ostream&zubarev::outputMatrix(std::ostream& out, const int* const matrix, size_t rows, size_t cols)
 {
+  common::BufferedWriter writer(out);
   for (size_t i = 0; i < rows; ++i) {
-    for (size_t j = 0; j < cols; ++j) {
-      if (j != 0) {
-        out << ' ';
-      }
-      out << matrix[i * cols + j];
-    }
-    out << '\n';
+    writer.write(matrix + i * cols, cols, ' ');
+    writer << '\n';
   }
+  writer.flush();
   return out;
 }
 
-int* zubarev::convertToSquare(int* matrix, size_t& rows, size_t& cols)
+common::MatrixView< const int > zubarev::convertToSquare(const int* matrix, size_t rows, size_t cols)
 {
-  size_t sizeOfMatrix = std::min(rows, cols);
-  int* square = reinterpret_cast< int* >(malloc(sizeOfMatrix * sizeOfMatrix * sizeof(int)));
-  if (!square) {
-    return nullptr;
-  }
-  if (rows == cols) {
-    for (size_t i = 0; i < rows*cols; ++i) {
-      square[i] = matrix[i];
-    }
-  } else {
-    for (size_t i = 0; i < sizeOfMatrix; ++i) {
-      for (size_t j = 0; j < sizeOfMatrix; ++j) {
-        square[i * sizeOfMatrix + j] = matrix[i * cols + j];
-      }
-    }
-    rows = cols = sizeOfMatrix;
-  }
-
-  return square;
+  return common::MatrixView< const int >(matrix, rows, cols).square();
 }
 
 int* zubarev::readMatrix(std::istream& in, size_t& rows, size_t& cols, int* matrix)
 {
-  for (size_t i = 0; i < rows * cols; ++i) {
-    if (!(in >> matrix[i])) {
-      break;
-    }
-  }
+  common::readIntegers(in, matrix, rows * cols);
   return matrix;
 }
 
-int zubarev::getCouOfColNoIden(const int* matrix, size_t rows, size_t cols)
+template< class T >
+int zubarev::getCouOfColNoIden(const common::MatrixView< const T >& matrix)
 {
-  size_t count = 0;
-  bool equalFlag = false;
-
-  for (size_t j = 0; j < cols; ++j) {
-    for (size_t i = 0; i < rows - 1; ++i) {
-      if (matrix[cols * i + j] == matrix[cols * (i + 1) + j]) {
-        equalFlag = true;
-        break;
-      }
-    }
-    if (!equalFlag) {
-      count++;
-    } else {
-      equalFlag = false;
-    }
-  }
+  common::Phase phase("getCouOfColNoIden", matrix.rows() * matrix.cols());
+  common::ColumnRepeats< T > repeats(matrix.cols());
+  common::parallelScanRows(matrix, repeats);
+  return repeats.distinct();
+}
 
-  return count;
+template< class T >
+long long zubarev::getMaxSumInDia(const common::MatrixView< const T >& matrix)
+{
+  common::Phase phase("getMaxSumInDia", matrix.rows() * matrix.cols());
+  return getMaxSumInDia(common::scanDiagonals(matrix), matrix.cols());
 }
 
-int zubarev::getMaxSumInDia(const int* matrix, size_t rows, size_t cols)
+int zubarev::getCouOfColNoIden(const common::SparseMatrix& matrix, size_t side)
 {
-  int maxSum = getMinInt();
-  int tempSum = 0;
-  for (size_t s = 1; s <= (cols / 2); ++s) {
-    for (size_t i = 0; i < rows - s; i++) {
-      tempSum += matrix[i * cols + (i + s)];
-    }
-    if (tempSum > maxSum) {
-      maxSum = tempSum;
-    }
-    tempSum = 0;
-  }
+  common::Phase phase("getCouOfColNoIden", matrix.nonzeros());
+  return common::distinctColumns(matrix, side, side);
+}
 
-  for (size_t s = 1; s <= (cols / 2); ++s) {
-    for (size_t i = s; i < rows; i++) {
-      tempSum += matrix[i * cols + (i - s)];
-    }
-    if (tempSum > maxSum) {
-      maxSum = tempSum;
-    }
-    tempSum = 0;
+long long zubarev::getMaxSumInDia(const common::SparseMatrix& matrix, size_t side)
+{
+  common::Phase phase("getMaxSumInDia", matrix.nonzeros());
+  return getMaxSumInDia(common::scanDiagonals(matrix, side, side), side);
+}
+
+long long zubarev::getMaxSumInDia(const common::DiagonalStats& diagonals, size_t side)
+{
+  long long maxSum = getMinInt();
+  for (size_t s = 1; s <= (side / 2); ++s) {
+    long long upper = diagonals.mainSum(diagonals.mainIndex(0, s));
+    long long lower = diagonals.mainSum(diagonals.mainIndex(s, 0));
+    maxSum = std::max(maxSum, std::max(upper, lower));
   }
 
   return maxSum;
 }
-